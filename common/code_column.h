@@ -0,0 +1,161 @@
+// code_column.h
+// Interned text columns for the Samarthaka tools.
+//
+// Low-cardinality text columns (zone, waste type, sensor status) are
+// interned once at load time into a uint8_t code column plus a small
+// dictionary.  Later passes compare or count bytes instead of strings:
+//
+//   static samarthaka::StringDict zoneDict;
+//   static uint8_t *ZoneCode;
+//   store.reserve(ZoneCode, rows);  store.commit();
+//   zoneDict.encode(Zone, rows, ZoneCode);
+//   size_t counts[256];
+//   samarthaka::histogram(ZoneCode, rows, counts);
+//   // counts[c] rows have zoneDict.name(c)
+//
+// A dictionary holds up to 255 distinct values; code 255 (NO_CODE) marks
+// values that did not fit.
+
+#ifndef SAMARTHAKA_CODE_COLUMN_H
+#define SAMARTHAKA_CODE_COLUMN_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+
+namespace samarthaka {
+
+const uint8_t NO_CODE = 255;
+
+class StringDict {
+public:
+    static const int MAX_CODES = 255;
+    static const int MAX_NAME = 31;         // longer values are cut here
+
+    StringDict() { clear(); }
+
+    void clear() {
+        n_ = 0;
+        memset(slot_, 0xFF, sizeof(slot_));
+    }
+
+    int size() const { return n_; }
+    const char *name(uint8_t code) const { return code < n_ ? name_[code] : ""; }
+
+    // Code of s, or -1 if it was never interned.
+    int find(const char *s) const {
+        char key[MAX_NAME + 1];
+        unsigned h = hash(s, key);
+        for (unsigned i = h;; i = (i + 1) & (SLOTS - 1)) {
+            if (slot_[i] == NO_CODE) return -1;
+            if (strcmp(name_[slot_[i]], key) == 0) return slot_[i];
+        }
+    }
+
+    // Code of s, adding it if new.  NO_CODE when the dictionary is full.
+    uint8_t intern(const char *s) {
+        char key[MAX_NAME + 1];
+        unsigned h = hash(s, key);
+        unsigned i = h;
+        for (;; i = (i + 1) & (SLOTS - 1)) {
+            if (slot_[i] == NO_CODE) break;
+            if (strcmp(name_[slot_[i]], key) == 0) return slot_[i];
+        }
+        if (n_ == MAX_CODES) return NO_CODE;
+        memcpy(name_[n_], key, sizeof(key));
+        slot_[i] = (uint8_t) n_;
+        return (uint8_t) n_++;
+    }
+
+    // Interns a fixed-width text column into out[0..n).  False if some
+    // value did not fit (its code is NO_CODE).
+    template <int W>
+    bool encode(const char (*col)[W], int n, uint8_t *out) {
+        bool ok = true;
+        for (int i = 0; i < n; i++) {
+            out[i] = intern(col[i]);
+            ok &= out[i] != NO_CODE;
+        }
+        return ok;
+    }
+
+private:
+    static const unsigned SLOTS = 512;      // power of two, > 2 * MAX_CODES
+
+    // FNV-1a over s, copied (cut to MAX_NAME) into key.
+    static unsigned hash(const char *s, char *key) {
+        unsigned h = 2166136261u;
+        int j = 0;
+        for (; j < MAX_NAME && s[j]; j++) {
+            key[j] = s[j];
+            h = (h ^ (unsigned char) s[j]) * 16777619u;
+        }
+        key[j] = 0;
+        return h & (SLOTS - 1);
+    }
+
+    int n_;
+    char name_[MAX_CODES][MAX_NAME + 1];
+    uint8_t slot_[SLOTS];                   // open addressing: code or NO_CODE
+};
+
+// counts[c] = rows with code c, for all 256 codes.  Four interleaved
+// sub-histograms keep repeated codes from serialising on one counter;
+// large columns are split across threads (0 = one per hardware thread).
+inline void histogram(const uint8_t *codes, size_t n, size_t counts[256], int threads = 0) {
+    const size_t PER_THREAD_MIN = 1 << 20;
+    if (threads <= 0) threads = (int) std::thread::hardware_concurrency();
+    if ((size_t) threads > n / PER_THREAD_MIN) threads = (int)(n / PER_THREAD_MIN);
+    if (threads < 1) threads = 1;
+
+    auto count = [codes](size_t lo, size_t hi, size_t *out) {
+        uint32_t sub[4][256] = {};
+        size_t i = lo;
+        for (; i + 4 <= hi; i += 4) {
+            sub[0][codes[i]]++;
+            sub[1][codes[i + 1]]++;
+            sub[2][codes[i + 2]]++;
+            sub[3][codes[i + 3]]++;
+        }
+        for (; i < hi; i++) sub[0][codes[i]]++;
+        for (int c = 0; c < 256; c++)
+            out[c] = (size_t) sub[0][c] + sub[1][c] + sub[2][c] + sub[3][c];
+    };
+
+    // uint32_t sub-counters: slices stay well below 4G rows
+    const size_t SLICE = (size_t) 1 << 31;
+    size_t part[256];
+    for (int c = 0; c < 256; c++) counts[c] = 0;
+    if (threads == 1) {
+        for (size_t lo = 0; lo < n; lo += SLICE) {
+            count(lo, n - lo < SLICE ? n : lo + SLICE, part);
+            for (int c = 0; c < 256; c++) counts[c] += part[c];
+        }
+        return;
+    }
+
+    size_t (*local)[256] = new size_t[threads][256];
+    std::thread *pool = new std::thread[threads];
+    for (int t = 0; t < threads; t++) {
+        size_t lo = n * t / threads, hi = n * (t + 1) / threads;
+        pool[t] = std::thread([=]() {
+            size_t buf[256];
+            for (int c = 0; c < 256; c++) local[t][c] = 0;
+            for (size_t a = lo; a < hi; a += SLICE) {
+                count(a, hi - a < SLICE ? hi : a + SLICE, buf);
+                for (int c = 0; c < 256; c++) local[t][c] += buf[c];
+            }
+        });
+    }
+    for (int t = 0; t < threads; t++) {
+        pool[t].join();
+        for (int c = 0; c < 256; c++) counts[c] += local[t][c];
+    }
+    delete[] pool;
+    delete[] local;
+}
+
+} // namespace samarthaka
+
+#endif
@@ -0,0 +1,97 @@
+// column_arena.h
+// Arena-backed column storage for the Samarthaka tools.
+//
+// Columns are plain pointers (int *BinID, char (*Zone)[16], ...) so the
+// existing BinID[i] / Zone[i] code keeps working.  Instead of fixed static
+// arrays they are sized from the real row count: reserve() queues a column,
+// commit() carves all queued columns out of one zeroed block, each column
+// 64-byte aligned and laid out back to back for cache-friendly scans.
+//
+//   static samarthaka::ColumnArena store;
+//   static int *BinID;
+//   static double *Lat;
+//   ...
+//   store.reserve(BinID, rows);
+//   store.reserve(Lat, rows);
+//   if (!store.commit()) { ...capacity error... }
+//
+// The arena owns every block it committed until it is destroyed.
+
+#ifndef SAMARTHAKA_COLUMN_ARENA_H
+#define SAMARTHAKA_COLUMN_ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+namespace samarthaka {
+
+class ColumnArena {
+public:
+    ColumnArena() {}
+    ~ColumnArena() {
+        while (blocks_) {
+            void *next = *(void **) blocks_;
+            free(blocks_);
+            blocks_ = next;
+        }
+    }
+
+    ColumnArena(const ColumnArena &) = delete;
+    ColumnArena &operator=(const ColumnArena &) = delete;
+
+    // Queues col to receive n zeroed elements on the next commit().
+    template <class T>
+    void reserve(T *&col, size_t n) { reserveBytes((void **) &col, n * sizeof(T)); }
+
+    void reserveBytes(void **ref, size_t bytes) {
+        if (npending_ < MAX_PENDING) pending_[npending_++] = Pending{ref, bytes};
+        else overflow_ = true;
+    }
+
+    // Allocates every queued column in one block.  False if the memory is
+    // not available (the queued pointers are left untouched).
+    bool commit() {
+        if (overflow_) return false;
+        size_t total = 0;
+        for (int i = 0; i < npending_; i++) {
+            size_t n = align(pending_[i].bytes);
+            if (n < pending_[i].bytes || total + n < total) return false;
+            total += n;
+        }
+        if (total > SIZE_MAX - 2 * ALIGN) return false;
+        // the first word of each block links to the previous block
+        char *block = (char *) calloc(1, total + 2 * ALIGN);
+        if (!block) return false;
+        char *p = (char *)(((uintptr_t) block + sizeof(void *) + ALIGN - 1) & ~(uintptr_t)(ALIGN - 1));
+        for (int i = 0; i < npending_; i++) {
+            *pending_[i].ref = p;
+            p += align(pending_[i].bytes);
+        }
+        *(void **) block = blocks_;
+        blocks_ = block;
+        bytes_ += total;
+        npending_ = 0;
+        return true;
+    }
+
+    size_t bytes() const { return bytes_; }
+
+private:
+    static const size_t ALIGN = 64;
+    static const int MAX_PENDING = 128;
+
+    struct Pending { void **ref; size_t bytes; };
+
+    static size_t align(size_t n) { return (n + ALIGN - 1) & ~(ALIGN - 1); }
+
+    Pending pending_[MAX_PENDING];
+    int npending_ = 0;
+    bool overflow_ = false;
+    void *blocks_ = nullptr;
+    size_t bytes_ = 0;
+};
+
+} // namespace samarthaka
+
+#endif
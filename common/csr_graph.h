@@ -0,0 +1,200 @@
+// csr_graph.h
+// Compressed-sparse-row graphs for the Samarthaka tools.
+//
+// Replaces the head[] / next[] linked-list adjacency: every node's arcs sit
+// back to back in two packed arrays (target, weight) found through one
+// offset array, so a relaxation loop streams through memory instead of
+// chasing next[].  The graph is built in two passes over the same edge
+// source, the first counting arcs per node and the second placing them, so
+// nothing is over-allocated.  Arrays come out of the caller's ColumnArena.
+//
+//   samarthaka::CsrGraph g;
+//   g.build(store, n, [&](auto &arc) {
+//       for (int i = 0; i < rows; i++) { arc(u, v, w); arc(v, u, w); }
+//   });
+//   for (int a = g.begin(u); a < g.end(u); a++) relax(g.target(a), g.weight(a));
+//
+// A node's arcs come out newest first, the order a head/next list walks
+// them in, so ported searches break ties exactly as before.  Arcs with an
+// endpoint outside [0, n) are dropped.
+//
+// reorderBfs() / reorderRcm() renumber the nodes so that neighbours get
+// nearby ids (fewer cache misses on per-node arrays).  After that the graph
+// uses internal ids: order(v) maps a caller id to its internal id and
+// node(i) maps back.  Both are the identity until a reorder.
+
+#ifndef SAMARTHAKA_CSR_GRAPH_H
+#define SAMARTHAKA_CSR_GRAPH_H
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+#include "column_arena.h"
+
+namespace samarthaka {
+
+class CsrGraph {
+public:
+    // Passed to the edge source; arc(u, v, w) adds the arc u -> v.
+    class Sink {
+    public:
+        void operator()(int u, int v, int w) {
+            if ((unsigned) u >= (unsigned) g_.n_ || (unsigned) v >= (unsigned) g_.n_) return;
+            if (!place_) {
+                g_.off_[u + 1]++;
+                return;
+            }
+            // off_[u + 1] counts down from the end of u's range
+            int a = --g_.off_[u + 1];
+            g_.to_[a] = v;
+            g_.w_[a] = w;
+        }
+
+    private:
+        friend class CsrGraph;
+        Sink(CsrGraph &g, bool place) : g_(g), place_(place) {}
+        CsrGraph &g_;
+        bool place_;
+    };
+
+    CsrGraph() {}
+    CsrGraph(const CsrGraph &) = delete;
+    CsrGraph &operator=(const CsrGraph &) = delete;
+
+    // Builds the graph on nodes [0, n).  edges(arc) is called twice and
+    // must emit the same arcs both times.  False if the arena is out of
+    // memory or there are more than INT_MAX arcs.
+    template <class F>
+    bool build(ColumnArena &store, int n, F edges) {
+        n_ = n < 0 ? 0 : n;
+        m_ = 0;
+        order_ = node_ = nullptr;
+        store.reserve(off_, (size_t) n_ + 1);
+        if (!store.commit()) return false;
+
+        Sink count(*this, false);
+        edges(count);
+        long long total = 0;
+        for (int u = 0; u < n_; u++) {
+            total += off_[u + 1];
+            if (total > INT_MAX) return false;
+            off_[u + 1] = (int) total;
+        }
+        m_ = (int) total;
+
+        store.reserve(to_, (size_t) m_);
+        store.reserve(w_, (size_t) m_);
+        if (!store.commit()) return false;
+        Sink place(*this, true);
+        edges(place);
+
+        // off_[u + 1] now holds the start of u's range: shift it down
+        memmove(off_, off_ + 1, sizeof(int) * n_);
+        off_[n_] = m_;
+        return true;
+    }
+
+    int nodes() const { return n_; }
+    int arcs() const { return m_; }
+
+    int begin(int u) const { return off_[u]; }
+    int end(int u) const { return off_[u + 1]; }
+    int degree(int u) const { return off_[u + 1] - off_[u]; }
+    int target(int a) const { return to_[a]; }
+    int weight(int a) const { return w_[a]; }
+
+    int order(int v) const { return order_ ? order_[v] : v; }
+    int node(int i) const { return node_ ? node_[i] : i; }
+
+    // Breadth-first numbering from root, then from every node not reached
+    // yet, in id order.
+    bool reorderBfs(ColumnArena &store, int root = 0) {
+        return renumber(store, false, root);
+    }
+
+    // Reverse Cuthill-McKee: breadth-first from a lowest-degree node of each
+    // component, neighbours queued by ascending degree, final order
+    // reversed.  Keeps the id distance across arcs (the bandwidth) small.
+    bool reorderRcm(ColumnArena &store) { return renumber(store, true, -1); }
+
+private:
+    bool renumber(ColumnArena &store, bool rcm, int root) {
+        int *perm, *seq, *off, *to, *w;
+        store.reserve(perm, (size_t) n_);      // internal id -> new id
+        store.reserve(seq, (size_t) n_);       // new id -> internal id
+        store.reserve(off, (size_t) n_ + 1);
+        store.reserve(to, (size_t) m_);
+        store.reserve(w, (size_t) m_);
+        if (!store.commit()) return false;
+
+        // seq doubles as the BFS queue; perm marks visited nodes
+        for (int v = 0; v < n_; v++) perm[v] = -1;
+        int *starts = nullptr;
+        if (rcm) {
+            // components start from their lowest-degree node
+            store.reserve(starts, (size_t) n_);
+            if (!store.commit()) return false;
+            for (int v = 0; v < n_; v++) starts[v] = v;
+            std::stable_sort(starts, starts + n_, [this](int a, int b) { return degree(a) < degree(b); });
+        }
+        if (root >= n_) root = -1;
+        int done = 0;
+        for (int s = -1; s < n_ && done < n_; s++) {
+            int r = s < 0 ? root : (rcm ? starts[s] : s);
+            if (r < 0 || perm[r] >= 0) continue;
+            perm[r] = done;
+            seq[done++] = r;
+            for (int q = done - 1; q < done; q++) {
+                int u = seq[q], from = done;
+                for (int a = begin(u); a < end(u); a++) {
+                    int v = to_[a];
+                    if (perm[v] >= 0) continue;
+                    perm[v] = done;
+                    seq[done++] = v;
+                }
+                if (rcm)
+                    std::sort(seq + from, seq + done, [this](int a, int b) {
+                        return degree(a) != degree(b) ? degree(a) < degree(b) : a < b;
+                    });
+            }
+        }
+        if (rcm) std::reverse(seq, seq + n_);
+        for (int i = 0; i < n_; i++) perm[seq[i]] = i;
+
+        // arcs keep their order within each node
+        off[0] = 0;
+        for (int i = 0; i < n_; i++) {
+            int u = seq[i], k = off[i];
+            for (int a = begin(u); a < end(u); a++, k++) {
+                to[k] = perm[to_[a]];
+                w[k] = w_[a];
+            }
+            off[i + 1] = k;
+        }
+
+        // compose with any earlier renumbering
+        if (order_) {
+            for (int v = 0; v < n_; v++) order_[v] = perm[order_[v]];
+            for (int i = 0; i < n_; i++) seq[i] = node_[seq[i]];
+        } else {
+            order_ = perm;
+        }
+        node_ = seq;
+        off_ = off;
+        to_ = to;
+        w_ = w;
+        return true;
+    }
+
+    int n_ = 0, m_ = 0;
+    int *off_ = nullptr;        // n_ + 1 offsets into to_ / w_
+    int *to_ = nullptr;
+    int *w_ = nullptr;
+    int *order_ = nullptr;      // caller id -> internal id, null: identity
+    int *node_ = nullptr;       // internal id -> caller id, null: identity
+};
+
+} // namespace samarthaka
+
+#endif
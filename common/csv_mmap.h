@@ -0,0 +1,855 @@
+// csv_mmap.h
+// Shared header-only CSV ingest used by the Samarthaka tools.
+//
+// The whole file is memory-mapped once, every line is split in place into
+// std::string_view fields (no std::string per field) and numbers are parsed
+// with std::from_chars.  Commas, quotes and newlines are located 32 bytes at
+// a time (AVX2, SSE2 or scalar, picked at runtime).  Two ways to use it:
+//
+//   1) Column binding - bind CSV columns straight onto the existing arrays:
+//
+//        samarthaka::CsvBinding csv;
+//        csv.bind(0, BinID);        // int[]
+//        csv.bind(1, Zone);         // char[][16]  (strncpy style, NUL terminated)
+//        csv.bind(2, Lat);          // double[]
+//        int rows = csv.load("samarthaka_waste_corrected.csv", MAX_BINS);
+//
+//      Columns may also be growable pointers sized from the row count
+//      (see column_arena.h):  csv.load(path, arena).
+//
+//   2) Row callback - for loaders with their own fallbacks:
+//
+//        samarthaka::CsvReader rd("samarthaka_grid.csv", samarthaka::CSV_QUOTED);
+//        rd.forEachRow([&](const samarthaka::CsvRow &row) { ... row[7] ... });
+//
+// Big exports can be parsed on all cores with CSV_PARALLEL: the file is cut
+// at newline boundaries, each chunk is parsed on its own thread, and every
+// row still lands at its original row index.  Link with -pthread.
+//
+// With CSV_SNAPSHOT the typed columns are also cached in <csv>.snap, a
+// binary columnar file that later runs map and copy instead of parsing.
+//
+// Needs C++17 (the default for g++ >= 11).  POSIX only (mmap).
+
+#ifndef SAMARTHAKA_CSV_MMAP_H
+#define SAMARTHAKA_CSV_MMAP_H
+
+#include <charconv>
+#include <string_view>
+#include <type_traits>
+#include <thread>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+#include <climits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "column_arena.h"
+
+namespace samarthaka {
+
+/* ============================================================
+   NUMBER PARSING (atoi / atof / stoi semantics, no allocation)
+   ============================================================ */
+
+// Parses the leading number of s like strtol/strtod do: leading blanks and a
+// '+' sign are skipped, trailing junk is ignored.  Returns false when no
+// digits were found or the value does not fit in T (where stoi would throw).
+template <class T>
+inline bool parseNumber(std::string_view s, T &out) {
+    const char *p = s.data(), *end = p + s.size();
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p < end && *p == '+') p++;
+    std::from_chars_result r;
+    if constexpr (std::is_floating_point<T>::value)
+        r = std::from_chars(p, end, out, std::chars_format::general);
+    else
+        r = std::from_chars(p, end, out, 10);
+    return r.ec == std::errc();
+}
+
+// atoi / atof analogue: returns def when nothing could be parsed.
+template <class T>
+inline T toNumber(std::string_view s, T def = T()) {
+    T v;
+    return parseNumber(s, v) ? v : def;
+}
+
+// strncpy(dst, field, W-1) into a NUL terminated fixed-width cell.
+template <size_t W>
+inline void copyText(char (&dst)[W], std::string_view s) {
+    size_t n = s.size() < W - 1 ? s.size() : W - 1;
+    memcpy(dst, s.data(), n);
+    memset(dst + n, 0, W - n);
+}
+
+/* ============================================================
+   MAPPED FILE
+   ============================================================ */
+
+class MappedFile {
+public:
+    MappedFile() {}
+    explicit MappedFile(const char *path) { open(path); }
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const char *path) {
+        close();
+        int fd = ::open(path, O_RDONLY);
+        if (fd < 0) return false;
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); return false; }
+        size_ = (size_t) st.st_size;
+        ok_ = true;
+        if (size_ > 0) {
+            void *p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, size_, MADV_SEQUENTIAL);
+                data_ = (const char *) p;
+                mapped_ = true;
+            } else {
+                // not mappable (pipe, odd filesystem): read it instead
+                char *buf = (char *) malloc(size_);
+                size_t got = 0;
+                while (buf && got < size_) {
+                    ssize_t r = ::read(fd, buf + got, size_ - got);
+                    if (r <= 0) break;
+                    got += (size_t) r;
+                }
+                data_ = buf;
+                size_ = got;
+                ok_ = (buf != nullptr);
+            }
+        }
+        ::close(fd);
+        return ok_;
+    }
+
+    void close() {
+        if (data_) {
+            if (mapped_) munmap((void *) data_, size_);
+            else free((void *) data_);
+        }
+        data_ = nullptr; size_ = 0; ok_ = false; mapped_ = false;
+    }
+
+    bool ok() const { return ok_; }
+    const char *data() const { return data_; }
+    size_t size() const { return size_; }
+
+private:
+    const char *data_ = nullptr;
+    size_t size_ = 0;
+    bool ok_ = false;
+    bool mapped_ = false;
+};
+
+/* ============================================================
+   FIELD SCANNER (AVX2 / SSE2 / scalar, picked at runtime)
+   ============================================================ */
+
+// One field of a line as byte offsets from the line start.  quoted is set
+// when the field contains '"' characters that still have to be stripped.
+struct CsvField { uint32_t begin, end; bool quoted; };
+
+namespace detail {
+
+struct ScanState {
+    CsvField *out;
+    int count, maxFields;
+    uint32_t start;       // offset where the current field began
+    bool fieldQuoted;     // current field has seen a '"'
+    bool inq;             // inside quotes at the end of the last block
+};
+
+inline uint32_t bitsBelow(int i) { return i >= 32 ? ~0u : (1u << i) - 1; }
+
+// Consumes one block's masks (bit i = byte base+i).  Quote parity is a
+// prefix XOR over the quote mask, so a comma splits only when an even
+// number of quotes precede it - the same toggle rule as splitCSVLine.
+inline void scanBlock(uint32_t base, uint32_t comma, uint32_t quote, ScanState &st) {
+    uint32_t inq = quote;
+    inq ^= inq << 1; inq ^= inq << 2; inq ^= inq << 4; inq ^= inq << 8; inq ^= inq << 16;
+    if (st.inq) inq = ~inq;
+    uint32_t sep = comma & ~inq;
+    int from = 0;
+    while (sep && st.count < st.maxFields - 1) {
+        int i = __builtin_ctz(sep);
+        st.fieldQuoted |= (quote & bitsBelow(i) & ~bitsBelow(from)) != 0;
+        st.out[st.count++] = CsvField{st.start, base + i, st.fieldQuoted};
+        st.start = base + i + 1;
+        st.fieldQuoted = false;
+        from = i + 1;
+        sep &= sep - 1;
+    }
+    st.fieldQuoted |= (quote & ~bitsBelow(from)) != 0;
+    st.inq ^= __builtin_popcount(quote) & 1;
+}
+
+// Byte-at-a-time scan of [p,end) from line start b; stops at '\n'.
+inline const char *scanTail(const char *b, const char *p, const char *end,
+                            bool quotes, ScanState &st) {
+    for (; p < end; p++) {
+        char c = *p;
+        if (c == '\n') break;
+        if (c == '"' && quotes) { st.inq = !st.inq; st.fieldQuoted = true; continue; }
+        if (c == ',' && !st.inq && st.count < st.maxFields - 1) {
+            uint32_t at = (uint32_t)(p - b);
+            st.out[st.count++] = CsvField{st.start, at, st.fieldQuoted};
+            st.start = at + 1;
+            st.fieldQuoted = false;
+        }
+    }
+    return p;
+}
+
+// Closes the last field at p (the '\n' or end of data).
+inline const char *scanFinish(const char *b, const char *p, ScanState &st, int &count) {
+    st.out[st.count++] = CsvField{st.start, (uint32_t)(p - b), st.fieldQuoted};
+    count = st.count;
+    return p;
+}
+
+// Splits the line starting at b into out[], returns the '\n' (or end).
+typedef const char *(*ScanFn)(const char *b, const char *end, bool quotes,
+                              CsvField *out, int &count, int maxFields);
+
+inline const char *scanScalar(const char *b, const char *end, bool quotes,
+                              CsvField *out, int &count, int maxFields) {
+    ScanState st{out, 0, maxFields, 0, false, false};
+    return scanFinish(b, scanTail(b, b, end, quotes, st), st, count);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("sse2")))
+inline const char *scanSse2(const char *b, const char *end, bool quotes,
+                            CsvField *out, int &count, int maxFields) {
+    ScanState st{out, 0, maxFields, 0, false, false};
+    const __m128i vc = _mm_set1_epi8(','), vq = _mm_set1_epi8('"'), vn = _mm_set1_epi8('\n');
+    const char *p = b;
+    while (end - p >= 16) {
+        __m128i x = _mm_loadu_si128((const __m128i *) p);
+        uint32_t nl = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, vn));
+        uint32_t live = nl ? bitsBelow(__builtin_ctz(nl)) : 0xFFFFu;
+        uint32_t c = (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, vc)) & live;
+        uint32_t q = quotes ? (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, vq)) & live : 0;
+        scanBlock((uint32_t)(p - b), c, q, st);
+        if (nl) { p += __builtin_ctz(nl); return scanFinish(b, p, st, count); }
+        p += 16;
+    }
+    return scanFinish(b, scanTail(b, p, end, quotes, st), st, count);
+}
+
+__attribute__((target("avx2")))
+inline const char *scanAvx2(const char *b, const char *end, bool quotes,
+                            CsvField *out, int &count, int maxFields) {
+    ScanState st{out, 0, maxFields, 0, false, false};
+    const __m256i vc = _mm256_set1_epi8(','), vq = _mm256_set1_epi8('"'), vn = _mm256_set1_epi8('\n');
+    const char *p = b;
+    while (end - p >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *) p);
+        uint32_t nl = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, vn));
+        uint32_t live = nl ? bitsBelow(__builtin_ctz(nl)) : ~0u;
+        uint32_t c = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, vc)) & live;
+        uint32_t q = quotes ? (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, vq)) & live : 0;
+        scanBlock((uint32_t)(p - b), c, q, st);
+        if (nl) { p += __builtin_ctz(nl); return scanFinish(b, p, st, count); }
+        p += 32;
+    }
+    return scanFinish(b, scanTail(b, p, end, quotes, st), st, count);
+}
+#endif
+
+inline ScanFn pickScanner() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return scanAvx2;
+    if (__builtin_cpu_supports("sse2")) return scanSse2;
+#endif
+    return scanScalar;
+}
+
+} // namespace detail
+
+// Field scanner for this CPU, chosen once on first use.
+inline detail::ScanFn csvScanner() {
+    static const detail::ScanFn fn = detail::pickScanner();
+    return fn;
+}
+
+/* ============================================================
+   ROW SPLITTING
+   ============================================================ */
+
+const int CSV_MAX_FIELDS = 64;
+
+enum CsvFlags {
+    CSV_QUOTED      = 1,   // '"' toggles quoting and is dropped (power.cpp rules)
+    CSV_KEEP_HEADER = 2,   // hand the header line to forEachRow as well
+    CSV_SKIP_STUBS  = 4,   // also skip 1-char lines, not just empty ones
+    CSV_PARALLEL    = 8,   // forEachRowIndexed: parse newline-aligned chunks on all cores
+    CSV_SNAPSHOT    = 16   // CsvBinding::load: reuse / write the <csv>.snap column cache
+};
+
+class CsvRow {
+public:
+    // Missing trailing fields read as "" - same as a failed getline(ss, tok, ',').
+    std::string_view operator[](int i) const {
+        return i < count_ ? field_[i] : std::string_view();
+    }
+    int size() const { return count_; }
+    std::string_view line() const { return line_; }
+
+    template <class T> T num(int i, T def = T()) const { return toNumber<T>((*this)[i], def); }
+    template <class T> bool get(int i, T &out) const { return parseNumber((*this)[i], out); }
+
+private:
+    friend class CsvSplitter;
+    std::string_view field_[CSV_MAX_FIELDS];
+    std::string_view line_;
+    int count_ = 0;
+};
+
+// Splits lines into CsvRows.  Unquoted fields point straight into the file;
+// fields holding '"' are unquoted into a scratch buffer the splitter owns,
+// so each parsing thread needs its own splitter.
+class CsvSplitter {
+public:
+    explicit CsvSplitter(unsigned flags = 0) : flags_(flags) {}
+    ~CsvSplitter() { free(scratch_); }
+
+    CsvSplitter(const CsvSplitter &) = delete;
+    CsvSplitter &operator=(const CsvSplitter &) = delete;
+
+    // true if [b,e) is a data line (not skipped as empty / stub)
+    bool wanted(const char *b, const char *e) const {
+        return (flags_ & CSV_SKIP_STUBS) ? e - b >= 2 : e > b;
+    }
+
+    // Splits the line starting at b (a trailing '\r' is dropped) and
+    // returns the position of its '\n', or end for the last line.
+    const char *splitLine(const char *b, const char *end, CsvRow &row) {
+        int n;
+        const char *nl = csvScanner()(b, end, (flags_ & CSV_QUOTED) != 0,
+                                      span_, n, CSV_MAX_FIELDS);
+        uint32_t len = (uint32_t)(nl - b);
+        if (len && b[len-1] == '\r') { len--; span_[n-1].end--; }
+        row.line_ = std::string_view(b, len);
+        row.count_ = n;
+
+        char *out = nullptr;
+        for (int i = 0; i < n; i++) {
+            const CsvField &f = span_[i];
+            if (!f.quoted) {
+                row.field_[i] = std::string_view(b + f.begin, f.end - f.begin);
+                continue;
+            }
+            // quotes toggle the in-quote state and are removed
+            if (!out) out = scratch(len);
+            char *start = out;
+            for (uint32_t k = f.begin; k < f.end; k++)
+                if (b[k] != '"') *out++ = b[k];
+            row.field_[i] = std::string_view(start, out - start);
+        }
+        return nl;
+    }
+
+private:
+    char *scratch(size_t need) {
+        if (need > scratchCap_) {
+            free(scratch_);
+            scratchCap_ = need * 2;
+            scratch_ = (char *) malloc(scratchCap_);
+        }
+        return scratch_;
+    }
+
+    unsigned flags_;
+    CsvField span_[CSV_MAX_FIELDS];
+    char *scratch_ = nullptr;
+    size_t scratchCap_ = 0;
+};
+
+// Walks the lines in [p,end): fn(b, e) per line with the '\r' trimmed.
+template <class Fn>
+inline void forEachLine(const char *p, const char *end, Fn fn) {
+    while (p < end) {
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        const char *eol = nl ? nl : end;
+        const char *next = nl ? nl + 1 : end;
+        if (eol > p && eol[-1] == '\r') eol--;
+        if (!fn(p, eol)) return;
+        p = next;
+    }
+}
+
+class CsvReader {
+public:
+    explicit CsvReader(const char *path, unsigned flags = 0)
+        : file_(path), flags_(flags), splitter_(flags) {}
+
+    bool ok() const { return file_.ok(); }
+
+    // Number of data lines (what forEachRow would visit without a limit).
+    int countRows() const {
+        return countFrom(body(), file_.data() + file_.size());
+    }
+
+    // True when the last forEachRow / forEachRowIndexed stopped at maxRows
+    // while the file still had more data lines.
+    bool truncated() const { return truncated_; }
+
+    // Calls fn(const CsvRow&) for each data line after the header, in file
+    // order, stopping after maxRows rows.  Returns the number of rows.
+    template <class Fn>
+    int forEachRow(Fn fn, int maxRows = INT_MAX) {
+        const char *p = body(), *end = file_.data() + file_.size();
+        int rows = 0;
+        CsvRow row;
+        while (p < end && rows < maxRows) {
+            const char *nl = splitter_.splitLine(p, end, row);
+            const char *eol = row.line().data() + row.line().size();
+            if (splitter_.wanted(p, eol)) {
+                fn((const CsvRow &) row);
+                rows++;
+            }
+            p = nl < end ? nl + 1 : end;
+        }
+        truncated_ = rows >= maxRows && countFrom(p, end) > 0;
+        return rows;
+    }
+
+    // Calls fn(const CsvRow&, int rowIndex) for rows 0..maxRows-1, where
+    // rowIndex is the row's position in the file.  With CSV_PARALLEL the
+    // file is cut into newline-aligned chunks that are parsed concurrently,
+    // so fn may run on several threads at once and must only write slot
+    // rowIndex of its output columns.  Row order is still the file order.
+    template <class Fn>
+    int forEachRowIndexed(Fn fn, int maxRows = INT_MAX, int threads = 0) {
+        const char *p = body(), *end = file_.data() + file_.size();
+        if (threads <= 0) threads = (int) std::thread::hardware_concurrency();
+        size_t chunkMin = 1 << 20;   // below ~1 MB per thread, threads don't pay off
+        if (threads > (int)((end - p) / chunkMin)) threads = (int)((end - p) / chunkMin);
+        if (!(flags_ & CSV_PARALLEL) || threads <= 1) {
+            int r = 0;
+            return forEachRow([&](const CsvRow &row) { fn(row, r++); }, maxRows);
+        }
+
+        // chunk boundaries, each just after a '\n'
+        std::vector<const char *> cut(threads + 1);
+        cut[0] = p;
+        for (int t = 1; t < threads; t++) {
+            const char *q = p + (size_t)(end - p) * t / threads;
+            if (q < cut[t-1]) q = cut[t-1];
+            const char *nl = (const char *) memchr(q, '\n', end - q);
+            cut[t] = nl ? nl + 1 : end;
+        }
+        cut[threads] = end;
+
+        // pass 1: rows per chunk -> first row index of every chunk
+        std::vector<int> first(threads + 1, 0);
+        runWorkers(threads, [&](int t) {
+            int n = 0;
+            forEachLine(cut[t], cut[t+1], [&](const char *b, const char *e) {
+                if (splitter_.wanted(b, e)) n++;
+                return true;
+            });
+            first[t+1] = n;
+        });
+        long long total = 0;
+        for (int t = 0; t < threads; t++) {
+            total += first[t+1];
+            first[t+1] = total > maxRows ? maxRows : (int) total;
+        }
+        truncated_ = total > maxRows;
+
+        // pass 2: parse each chunk into its own slice of the output
+        runWorkers(threads, [&](int t) {
+            CsvSplitter sp(flags_);
+            CsvRow row;
+            int r = first[t], stop = first[t+1];
+            const char *q = cut[t], *qend = cut[t+1];
+            while (q < qend && r < stop) {
+                const char *nl = sp.splitLine(q, qend, row);
+                const char *eol = row.line().data() + row.line().size();
+                if (sp.wanted(q, eol)) fn((const CsvRow &) row, r++);
+                q = nl < qend ? nl + 1 : qend;
+            }
+        });
+        return first[threads];
+    }
+
+private:
+    // start of the first data line
+    const char *body() const {
+        const char *p = file_.data(), *end = p + file_.size();
+        if (!p || (flags_ & CSV_KEEP_HEADER)) return p;
+        const char *nl = (const char *) memchr(p, '\n', end - p);
+        return nl ? nl + 1 : end;
+    }
+
+    int countFrom(const char *p, const char *end) const {
+        long long n = 0;
+        forEachLine(p, end, [&](const char *b, const char *e) {
+            if (splitter_.wanted(b, e)) n++;
+            return true;
+        });
+        return n > INT_MAX ? INT_MAX : (int) n;
+    }
+
+    template <class Fn>
+    static void runWorkers(int threads, Fn fn) {
+        std::vector<std::thread> pool;
+        for (int t = 1; t < threads; t++) pool.emplace_back(fn, t);
+        fn(0);
+        for (auto &th : pool) th.join();
+    }
+
+    MappedFile file_;
+    unsigned flags_;
+    CsvSplitter splitter_;
+    bool truncated_ = false;
+};
+
+/* ============================================================
+   COLUMN SNAPSHOT (binary cache of already-typed columns)
+   ============================================================ */
+
+// Column element types shared by the snapshot and the column binding.
+enum ColumnType { COL_I32, COL_I64, COL_U64, COL_F64, COL_TEXT };
+
+template <class T> struct ColumnTraits;
+template <> struct ColumnTraits<int>                { static const ColumnType type = COL_I32; };
+template <> struct ColumnTraits<long long>          { static const ColumnType type = COL_I64; };
+template <> struct ColumnTraits<unsigned long long> { static const ColumnType type = COL_U64; };
+template <> struct ColumnTraits<double>             { static const ColumnType type = COL_F64; };
+template <size_t W> struct ColumnTraits<char[W]>    { static const ColumnType type = COL_TEXT; };
+
+// <csv>.snap layout, version 2 (native endianness, every offset 64-aligned):
+//   SnapHeader | SnapColumn[ncols] | column 0 data | column 1 data | ...
+// A snapshot is used only while the CSV still has the recorded size and
+// mtime and the column layout/flags/row limit still match; otherwise the
+// caller re-parses the CSV and rewrites the snapshot.  load() also checks
+// the column bytes against dataSum and every text cell for its NUL, so a
+// damaged file is re-parsed rather than copied in.
+const uint32_t SNAP_VERSION = 2;
+
+struct SnapHeader {
+    char magic[8];          // "SKSNAP\0\0"
+    uint32_t version;
+    uint32_t ncols;
+    uint64_t srcSize;       // CSV size in bytes
+    int64_t srcMtimeNs;     // CSV mtime
+    uint64_t schema;        // hash of column tags/types/widths, flags, row limit
+    uint64_t rows;
+    uint64_t fileSize;      // expected snapshot length
+    uint64_t dataSum;       // dataHash of the column bytes, in column order
+    uint64_t checksum;      // FNV-1a of header (this field zeroed) + directory
+};
+
+struct SnapColumn {
+    uint32_t tag;           // CSV column index
+    uint32_t type;          // ColumnType
+    uint64_t width;         // bytes per row
+    uint64_t offset;        // from file start
+};
+
+inline uint64_t fnv1a(const void *p, size_t n, uint64_t h = 1469598103934665603ull) {
+    const unsigned char *c = (const unsigned char *) p;
+    for (size_t i = 0; i < n; i++) { h ^= c[i]; h *= 1099511628211ull; }
+    return h;
+}
+
+// FNV-1a style over 8-byte words (bytes for the tail): cheap enough to run
+// over every column of a big snapshot.
+inline uint64_t dataHash(const void *p, size_t n, uint64_t h = 1469598103934665603ull) {
+    const unsigned char *c = (const unsigned char *) p;
+    for (; n >= 8; c += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, c, 8);
+        h = (h ^ w) * 1099511628211ull;
+        h ^= h >> 29;
+    }
+    return fnv1a(c, n, h);
+}
+
+class ColumnSnapshot {
+public:
+    explicit ColumnSnapshot(unsigned flags = 0) : flags_(flags) {}
+
+    // dst: int/long long/unsigned long long/double or char[W] column
+    template <class T>
+    void add(int tag, T *dst) { add(tag, ColumnTraits<T>::type, dst, sizeof(T)); }
+
+    void add(int tag, ColumnType type, void *dst, size_t width) {
+        if (ncols_ < CSV_MAX_FIELDS) cols_[ncols_++] = Col{tag, type, dst, width};
+    }
+
+    // Row count of csvPath's snapshot, or -1 when there is no usable one.
+    // Lets growable columns be sized before load().
+    int rowsIn(const char *csvPath, int maxRows) const {
+        MappedFile f;
+        const SnapHeader *h = open(csvPath, maxRows, f);
+        return h ? (int) h->rows : -1;
+    }
+
+    // Copies the cached columns of csvPath into the registered arrays.
+    // False when there is no usable snapshot (caller parses the CSV).
+    bool load(const char *csvPath, int maxRows, int &rows) {
+        MappedFile f;
+        const SnapHeader *h = open(csvPath, maxRows, f);
+        if (!h) return false;
+        const SnapColumn *dir = (const SnapColumn *)(h + 1);
+        uint64_t sum = dataHash(nullptr, 0);
+        for (int c = 0; c < ncols_; c++) {
+            const char *src = f.data() + dir[c].offset;
+            size_t width = dir[c].width;
+            sum = dataHash(src, h->rows * width, sum);
+            if (cols_[c].type == COL_TEXT)
+                for (uint64_t r = 0; r < h->rows; r++)
+                    if (src[r * width + width - 1] != 0) return false;
+        }
+        if (sum != h->dataSum) return false;
+        for (int c = 0; c < ncols_; c++)
+            memcpy(cols_[c].dst, f.data() + dir[c].offset, h->rows * dir[c].width);
+        rows = (int) h->rows;
+        return true;
+    }
+
+    // Writes rows 0..rows-1 of the registered arrays as csvPath's snapshot.
+    // Best effort: a read-only folder just means no cache.
+    bool save(const char *csvPath, int maxRows, int rows) {
+        SnapHeader h;
+        char snapPath[4096], tmpPath[4200];
+        if (!describe(csvPath, maxRows, h, snapPath)) return false;
+        SnapColumn dir[CSV_MAX_FIELDS];
+        uint64_t off = align64(sizeof h + ncols_ * sizeof(SnapColumn));
+        for (int c = 0; c < ncols_; c++) {
+            dir[c] = SnapColumn{(uint32_t) cols_[c].tag, (uint32_t) cols_[c].type,
+                                (uint64_t) cols_[c].width, off};
+            off = align64(off + (uint64_t) rows * cols_[c].width);
+        }
+        h.rows = (uint64_t) rows;
+        h.fileSize = off;
+        h.dataSum = dataHash(nullptr, 0);
+        for (int c = 0; c < ncols_; c++)
+            h.dataSum = dataHash(cols_[c].dst, (size_t) rows * cols_[c].width, h.dataSum);
+        h.checksum = checksum(h, dir);
+
+        snprintf(tmpPath, sizeof tmpPath, "%s.tmp", snapPath);
+        int fd = ::open(tmpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) return false;
+        bool ok = writeAll(fd, &h, sizeof h) &&
+                  writeAll(fd, dir, ncols_ * sizeof(SnapColumn));
+        for (int c = 0; c < ncols_ && ok; c++)
+            ok = lseek(fd, (off_t) dir[c].offset, SEEK_SET) >= 0 &&
+                 writeAll(fd, cols_[c].dst, (size_t) rows * cols_[c].width);
+        ok = ok && ftruncate(fd, (off_t) off) == 0;
+        ::close(fd);
+        // rename() makes the new snapshot appear atomically
+        if (!ok || rename(tmpPath, snapPath) != 0) { unlink(tmpPath); return false; }
+        return true;
+    }
+
+private:
+    struct Col { int tag; ColumnType type; void *dst; size_t width; };
+
+    // Maps csvPath's snapshot into f and checks it against the CSV and the
+    // registered layout.  Returns its header, or nullptr if it is stale.
+    const SnapHeader *open(const char *csvPath, int maxRows, MappedFile &f) const {
+        SnapHeader want;
+        char snapPath[4096];
+        if (!describe(csvPath, maxRows, want, snapPath)) return nullptr;
+        if (!f.open(snapPath) || f.size() < sizeof(SnapHeader) + ncols_ * sizeof(SnapColumn))
+            return nullptr;
+
+        SnapHeader h;
+        memcpy(&h, f.data(), sizeof h);
+        const SnapColumn *dir = (const SnapColumn *)(f.data() + sizeof h);
+        if (memcmp(h.magic, want.magic, 8) != 0 || h.version != SNAP_VERSION ||
+            h.ncols != (uint32_t) ncols_ || h.srcSize != want.srcSize ||
+            h.srcMtimeNs != want.srcMtimeNs || h.schema != want.schema ||
+            h.fileSize != f.size() || h.rows > (uint64_t) maxRows ||
+            h.checksum != checksum(h, dir))
+            return nullptr;
+        for (int c = 0; c < ncols_; c++) {
+            uint64_t bytes = h.rows * dir[c].width;
+            if (dir[c].width != cols_[c].width || dir[c].offset + bytes > f.size()) return nullptr;
+        }
+        return (const SnapHeader *) f.data();
+    }
+
+    static uint64_t align64(uint64_t x) { return (x + 63) & ~(uint64_t) 63; }
+
+    static uint64_t checksum(SnapHeader h, const SnapColumn *dir) {
+        h.checksum = 0;
+        return fnv1a(dir, h.ncols * sizeof(SnapColumn), fnv1a(&h, sizeof h));
+    }
+
+    static bool writeAll(int fd, const void *p, size_t n) {
+        const char *c = (const char *) p;
+        while (n) {
+            ssize_t w = ::write(fd, c, n);
+            if (w <= 0) return false;
+            c += w; n -= (size_t) w;
+        }
+        return true;
+    }
+
+    // Header fields that identify csvPath's current contents and this layout.
+    bool describe(const char *csvPath, int maxRows, SnapHeader &h, char *snapPath) const {
+        struct stat st;
+        if (stat(csvPath, &st) != 0) return false;
+        if (snprintf(snapPath, 4096, "%s.snap", csvPath) >= 4096) return false;
+        memset(&h, 0, sizeof h);
+        memcpy(h.magic, "SKSNAP\0\0", 8);
+        h.version = SNAP_VERSION;
+        h.ncols = (uint32_t) ncols_;
+        h.srcSize = (uint64_t) st.st_size;
+        h.srcMtimeNs = (int64_t) st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+        uint64_t sh = fnv1a(&flags_, sizeof flags_);
+        sh = fnv1a(&maxRows, sizeof maxRows, sh);
+        for (int c = 0; c < ncols_; c++) {
+            uint64_t d[3] = {(uint64_t) cols_[c].tag, (uint64_t) cols_[c].type, cols_[c].width};
+            sh = fnv1a(d, sizeof d, sh);
+        }
+        h.schema = sh;
+        return true;
+    }
+
+    unsigned flags_;
+    Col cols_[CSV_MAX_FIELDS];
+    int ncols_ = 0;
+};
+
+/* ============================================================
+   TYPED COLUMN BINDING
+   ============================================================ */
+
+// Binds CSV columns to program columns.  A column is either a fixed array
+// (int BinID[MAX_BINS], char Zone[MAX_BINS][16]) or a growable pointer
+// (int *BinID, char (*Zone)[16]) that load() sizes from the row count and
+// allocates from a ColumnArena.  Element types: int, long long,
+// unsigned long long, double, char[W].
+class CsvBinding {
+public:
+    template <class T, size_t N>
+    void bind(int col, T (&dst)[N]) { add(col, ColumnTraits<T>::type, dst, nullptr, sizeof(T), N); }
+    template <class T>
+    void bind(int col, T *&dst)     { add(col, ColumnTraits<T>::type, nullptr, (void **) &dst, sizeof(T), 0); }
+
+    // Fills fixed-array columns from the first rows of the file.  More data
+    // rows than maxRows (or than a bound array holds) is a capacity error.
+    int load(const char *path, int maxRows, unsigned flags = 0) {
+        return loadInto(path, nullptr, maxRows, flags);
+    }
+
+    // Sizes the growable columns to the file's row count, allocates them in
+    // arena and fills them.
+    int load(const char *path, ColumnArena &arena, unsigned flags = 0) {
+        return loadInto(path, &arena, INT_MAX, flags);
+    }
+
+    // With CSV_PARALLEL rows are parsed on all cores.  With CSV_SNAPSHOT the
+    // typed columns come from <path>.snap when it is current, and the
+    // snapshot is (re)written after a CSV parse.
+    // Both loads return the row count, or -1 with error() set.
+    const char *error() const { return err_; }
+
+private:
+    struct Slot { int col; ColumnType type; void *dst; void **ref; size_t width; size_t cap; };
+
+    void add(int col, ColumnType t, void *dst, void **ref, size_t width, size_t cap) {
+        if (nslots_ < CSV_MAX_FIELDS) slots_[nslots_++] = Slot{col, t, dst, ref, width, cap};
+    }
+
+    void describe(ColumnSnapshot &snap) const {
+        for (int s = 0; s < nslots_; s++)
+            snap.add(slots_[s].col, slots_[s].type, slots_[s].ref ? *slots_[s].ref : slots_[s].dst,
+                     slots_[s].width);
+    }
+
+    int fail(const char *fmt, const char *path, long long n = 0) {
+        snprintf(err_, sizeof err_, fmt, path, n);
+        return -1;
+    }
+
+    int loadInto(const char *path, ColumnArena *arena, int maxRows, unsigned flags) {
+        bool growable = false;
+        for (int s = 0; s < nslots_; s++) {
+            if (slots_[s].ref) growable = true;
+            else if (slots_[s].cap < (size_t) maxRows) maxRows = (int) slots_[s].cap;
+        }
+        if (growable && !arena) return fail("%s: growable columns need a ColumnArena", path);
+
+        CsvReader rd(path, flags);
+        if (!rd.ok()) return fail("cannot open %s", path);
+
+        unsigned snapFlags = flags & ~CSV_PARALLEL;
+        int cached = -1;
+        if (flags & CSV_SNAPSHOT) {
+            ColumnSnapshot probe(snapFlags);
+            describe(probe);
+            cached = probe.rowsIn(path, maxRows);
+        }
+        // growable columns hold exactly the counted rows; the snapshot
+        // schema keeps keying on the caller's limit
+        int capacity = maxRows;
+        if (growable) {
+            int rows = cached >= 0 ? cached : rd.countRows();
+            for (int s = 0; s < nslots_; s++)
+                if (slots_[s].ref) arena->reserveBytes(slots_[s].ref, (size_t) rows * slots_[s].width);
+            if (!arena->commit()) return fail("%s: out of memory for %lld rows", path, rows);
+            if (rows < capacity) capacity = rows;
+        }
+
+        ColumnSnapshot snap(snapFlags);
+        describe(snap);
+        int rows;
+        if (cached >= 0 && snap.load(path, maxRows, rows)) return rows;
+
+        rows = rd.forEachRowIndexed([&](const CsvRow &row, int r) {
+            for (int s = 0; s < nslots_; s++) store(slots_[s], r, row[slots_[s].col]);
+        }, capacity);
+        if (rd.truncated())
+            return fail("%s has more than %lld rows (capacity exceeded)", path, capacity);
+        if (flags & CSV_SNAPSHOT) snap.save(path, maxRows, rows);
+        return rows;
+    }
+
+    static void store(const Slot &s, int r, std::string_view f) {
+        void *dst = s.ref ? *s.ref : s.dst;
+        switch (s.type) {
+        case COL_I32: ((int *) dst)[r] = toNumber<int>(f); break;
+        case COL_I64: ((long long *) dst)[r] = toNumber<long long>(f); break;
+        case COL_U64: ((unsigned long long *) dst)[r] = toNumber<unsigned long long>(f); break;
+        case COL_F64: ((double *) dst)[r] = toNumber<double>(f); break;
+        case COL_TEXT: {
+            char *cell = (char *) dst + (size_t) r * s.width;
+            size_t n = f.size() < s.width - 1 ? f.size() : s.width - 1;
+            memcpy(cell, f.data(), n);
+            memset(cell + n, 0, s.width - n);
+            break;
+        }
+        }
+    }
+
+    Slot slots_[CSV_MAX_FIELDS];
+    int nslots_ = 0;
+    char err_[512] = "";
+};
+
+} // namespace samarthaka
+
+#endif
@@ -0,0 +1,303 @@
+// id_bitmap.h
+// Integer ID sets for the Samarthaka tools.
+//
+// Two layouts behind one insert/contains API:
+//   - dense:  one bit per ID in [lo, hi), chosen by reset(lo, hi) when the
+//             ID range is bounded.  A lookup is one load and a shift.
+//   - sparse: roaring-style.  IDs are split on their high 16 bits; each
+//             64K chunk holds either a sorted uint16_t array (up to 4096
+//             entries) or a 1024-word bitset, whichever is smaller.
+// A default-constructed set is sparse.  Inserting outside a dense set's
+// range moves it to the sparse layout, so callers never lose an ID.
+//
+//   samarthaka::IdBitmap faults;
+//   faults.reset(minId, maxId + 1);
+//   faults.insert(id);
+//   if (faults.contains(id)) ...
+//   faults.forEachInRange(0, 20, [](uint32_t id) { ... });
+//   zoneBins.forEachAnd(faults, [](uint32_t id) { ... });
+
+#ifndef SAMARTHAKA_ID_BITMAP_H
+#define SAMARTHAKA_ID_BITMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace samarthaka {
+
+class IdBitmap {
+public:
+    // Largest ID range reset() keeps dense (16M bits = 2 MB).
+    static const uint64_t DENSE_LIMIT = 1ull << 24;
+
+    IdBitmap() {}
+
+    // Empties the set.  IDs are expected in [lo, hi): the set is dense when
+    // that range is small enough, sparse otherwise.
+    void reset(uint32_t lo, uint32_t hi) {
+        clear();
+        if (hi <= lo || (uint64_t) hi - lo > DENSE_LIMIT) return;
+        dense_ = true;
+        base_ = lo & ~63u;
+        words_.assign(((uint64_t) hi - base_ + 63) / 64, 0);
+    }
+
+    // Empties the set and returns it to the sparse layout.
+    void clear() {
+        dense_ = false;
+        base_ = 0;
+        card_ = 0;
+        words_.clear();
+        keys_.clear();
+        chunks_.clear();
+    }
+
+    size_t size() const { return card_; }
+    bool dense() const { return dense_; }
+
+    void insert(uint32_t id) {
+        if (dense_) {
+            if (inDense(id)) {
+                uint64_t &w = words_[(id - base_) >> 6];
+                uint64_t bit = 1ull << ((id - base_) & 63);
+                card_ += !(w & bit);
+                w |= bit;
+                return;
+            }
+            toSparse();
+        }
+        Chunk &c = chunkFor((uint16_t)(id >> 16));
+        if (c.add((uint16_t) id)) card_++;
+    }
+
+    // Returns true if id was present.
+    bool erase(uint32_t id) {
+        if (dense_) {
+            if (!inDense(id)) return false;
+            uint64_t &w = words_[(id - base_) >> 6];
+            uint64_t bit = 1ull << ((id - base_) & 63);
+            if (!(w & bit)) return false;
+            w &= ~bit;
+            card_--;
+            return true;
+        }
+        int k = findKey((uint16_t)(id >> 16));
+        if (k < 0 || !chunks_[k].remove((uint16_t) id)) return false;
+        card_--;
+        if (chunks_[k].card == 0) {
+            keys_.erase(keys_.begin() + k);
+            chunks_.erase(chunks_.begin() + k);
+        }
+        return true;
+    }
+
+    bool contains(uint32_t id) const {
+        if (dense_)
+            return inDense(id) && (words_[(id - base_) >> 6] >> ((id - base_) & 63) & 1);
+        int k = findKey((uint16_t)(id >> 16));
+        return k >= 0 && chunks_[k].has((uint16_t) id);
+    }
+
+    // Calls fn(id) for every member, in ascending order.
+    template <class F>
+    void forEach(F fn) const {
+        if (dense_) {
+            forEachInRange(base_, (uint32_t) std::min<uint64_t>(UINT32_MAX, base_ + words_.size() * 64), fn);
+            if (contains(UINT32_MAX)) fn(UINT32_MAX);
+            return;
+        }
+        for (size_t k = 0; k < keys_.size(); k++) {
+            uint32_t high = (uint32_t) keys_[k] << 16;
+            chunks_[k].forEach(0, 0xFFFF, [&](uint32_t low) { fn(high | low); });
+        }
+    }
+
+    // Calls fn(id) for every member in [lo, hi), in ascending order.
+    template <class F>
+    void forEachInRange(uint32_t lo, uint32_t hi, F fn) const {
+        if (hi <= lo) return;
+        if (dense_) {
+            uint64_t a = std::max<uint64_t>(lo, base_);
+            uint64_t b = std::min<uint64_t>(hi, base_ + words_.size() * 64);
+            for (uint64_t i = a; i < b;) {
+                uint64_t w = words_[(i - base_) >> 6] >> ((i - base_) & 63);
+                uint64_t wordEnd = std::min<uint64_t>(b, ((i - base_) | 63) + base_ + 1);
+                while (w) {
+                    uint64_t id = i + __builtin_ctzll(w);
+                    if (id >= wordEnd) break;
+                    fn((uint32_t) id);
+                    w &= w - 1;
+                }
+                i = wordEnd;
+            }
+            return;
+        }
+        uint32_t hiLast = hi - 1;
+        size_t k = std::lower_bound(keys_.begin(), keys_.end(), (uint16_t)(lo >> 16)) - keys_.begin();
+        for (; k < keys_.size() && keys_[k] <= (hiLast >> 16); k++) {
+            uint32_t high = (uint32_t) keys_[k] << 16;
+            uint32_t from = keys_[k] == (lo >> 16) ? (lo & 0xFFFF) : 0;
+            uint32_t to = keys_[k] == (hiLast >> 16) ? (hiLast & 0xFFFF) : 0xFFFF;
+            chunks_[k].forEach(from, to, [&](uint32_t low) { fn(high | low); });
+        }
+    }
+
+    size_t countInRange(uint32_t lo, uint32_t hi) const {
+        size_t n = 0;
+        forEachInRange(lo, hi, [&n](uint32_t) { n++; });
+        return n;
+    }
+
+    // Calls fn(id) for every id in both sets, in ascending order.
+    template <class F>
+    void forEachAnd(const IdBitmap &other, F fn) const {
+        if (dense_ && other.dense_) {
+            // both bases are multiples of 64, so the words line up
+            uint64_t a = std::max(base_, other.base_);
+            uint64_t b = std::min(base_ + words_.size() * 64,
+                                  other.base_ + other.words_.size() * 64);
+            for (uint64_t i = a; i < b; i += 64) {
+                uint64_t w = words_[(i - base_) >> 6] & other.words_[(i - other.base_) >> 6];
+                while (w) {
+                    fn((uint32_t)(i + __builtin_ctzll(w)));
+                    w &= w - 1;
+                }
+            }
+            return;
+        }
+        // walk the smaller set, probe the larger
+        const IdBitmap &small = card_ <= other.card_ ? *this : other;
+        const IdBitmap &large = card_ <= other.card_ ? other : *this;
+        small.forEach([&](uint32_t id) {
+            if (large.contains(id)) fn(id);
+        });
+    }
+
+    size_t countAnd(const IdBitmap &other) const {
+        size_t n = 0;
+        forEachAnd(other, [&n](uint32_t) { n++; });
+        return n;
+    }
+
+private:
+    static const int ARRAY_MAX = 4096;      // array chunks above this become bitsets
+
+    struct Chunk {
+        int card = 0;
+        std::vector<uint16_t> arr;          // sorted, when bits is empty
+        std::vector<uint64_t> bits;         // 1024 words, when in bitset form
+
+        bool has(uint16_t low) const {
+            if (!bits.empty()) return bits[low >> 6] >> (low & 63) & 1;
+            return std::binary_search(arr.begin(), arr.end(), low);
+        }
+
+        bool add(uint16_t low) {
+            if (!bits.empty()) {
+                uint64_t bit = 1ull << (low & 63);
+                if (bits[low >> 6] & bit) return false;
+                bits[low >> 6] |= bit;
+                card++;
+                return true;
+            }
+            auto it = std::lower_bound(arr.begin(), arr.end(), low);
+            if (it != arr.end() && *it == low) return false;
+            arr.insert(it, low);
+            card++;
+            if (card > ARRAY_MAX) {
+                bits.assign(1024, 0);
+                for (uint16_t v : arr) bits[v >> 6] |= 1ull << (v & 63);
+                std::vector<uint16_t>().swap(arr);
+            }
+            return true;
+        }
+
+        bool remove(uint16_t low) {
+            if (!bits.empty()) {
+                uint64_t bit = 1ull << (low & 63);
+                if (!(bits[low >> 6] & bit)) return false;
+                bits[low >> 6] &= ~bit;
+                card--;
+                if (card <= ARRAY_MAX) {
+                    arr.reserve(card);
+                    forEach(0, 0xFFFF, [this](uint32_t v) { arr.push_back((uint16_t) v); });
+                    std::vector<uint64_t>().swap(bits);
+                }
+                return true;
+            }
+            auto it = std::lower_bound(arr.begin(), arr.end(), low);
+            if (it == arr.end() || *it != low) return false;
+            arr.erase(it);
+            card--;
+            return true;
+        }
+
+        // Members with low bits in [from, to], ascending.
+        template <class F>
+        void forEach(uint32_t from, uint32_t to, F fn) const {
+            if (bits.empty()) {
+                auto it = std::lower_bound(arr.begin(), arr.end(), (uint16_t) from);
+                for (; it != arr.end() && *it <= to; ++it) fn((uint32_t) *it);
+                return;
+            }
+            for (uint32_t wi = from >> 6; wi <= (to >> 6); wi++) {
+                uint64_t w = bits[wi];
+                if (wi == (from >> 6)) w &= ~0ull << (from & 63);
+                if (wi == (to >> 6) && (to & 63) != 63) w &= (2ull << (to & 63)) - 1;
+                while (w) {
+                    fn((wi << 6) | __builtin_ctzll(w));
+                    w &= w - 1;
+                }
+            }
+        }
+    };
+
+    bool inDense(uint32_t id) const {
+        return id >= base_ && (uint64_t)(id - base_) < words_.size() * 64;
+    }
+
+    int findKey(uint16_t key) const {
+        auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        return it != keys_.end() && *it == key ? (int)(it - keys_.begin()) : -1;
+    }
+
+    Chunk &chunkFor(uint16_t key) {
+        auto it = std::lower_bound(keys_.begin(), keys_.end(), key);
+        size_t k = it - keys_.begin();
+        if (it == keys_.end() || *it != key) {
+            keys_.insert(it, key);
+            chunks_.insert(chunks_.begin() + k, Chunk());
+        }
+        return chunks_[k];
+    }
+
+    // Moves the dense members into sparse chunks.
+    void toSparse() {
+        std::vector<uint64_t> words;
+        words.swap(words_);
+        uint32_t base = base_;
+        dense_ = false;
+        base_ = 0;
+        for (size_t wi = 0; wi < words.size(); wi++) {
+            uint64_t w = words[wi];
+            while (w) {
+                uint32_t id = base + (uint32_t)(wi * 64) + __builtin_ctzll(w);
+                chunkFor((uint16_t)(id >> 16)).add((uint16_t) id);
+                w &= w - 1;
+            }
+        }
+    }
+
+    bool dense_ = false;
+    uint32_t base_ = 0;                     // dense: first ID of words_[0], multiple of 64
+    size_t card_ = 0;
+    std::vector<uint64_t> words_;           // dense bits
+    std::vector<uint16_t> keys_;            // sparse: sorted high halves
+    std::vector<Chunk> chunks_;             // sparse: one chunk per key
+};
+
+} // namespace samarthaka
+
+#endif
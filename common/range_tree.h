@@ -0,0 +1,185 @@
+// range_tree.h
+// Lazy segment tree over a numeric column for the Samarthaka tools.
+//
+// Range add and range assign, with sum / min / max of a range read back in
+// one walk.  Nodes live in the bottom-up 2n layout: leaves at [n, 2n), node
+// i above 2i and 2i + 1, no padding to a power of two and no recursion.
+// Pending updates sit on internal nodes and are pushed down only along the
+// two boundary paths of the next operation, so every call is O(log n).
+// Arrays come out of the caller's ColumnArena.
+//
+//   samarthaka::RangeTree<long long> meters;
+//   meters.build(store, MeterMonth, n);
+//   meters.add(100, 250, -40);                  // rows [100, 250)
+//   long long s = meters.query(0, n).sum;
+//
+// T is any arithmetic type; sums are taken in T, so pick one wide enough.
+
+#ifndef SAMARTHAKA_RANGE_TREE_H
+#define SAMARTHAKA_RANGE_TREE_H
+
+#include <limits>
+
+#include "column_arena.h"
+
+namespace samarthaka {
+
+template <class T>
+class RangeTree {
+public:
+    struct Agg { T sum, min, max; };
+
+    RangeTree() {}
+    RangeTree(const RangeTree &) = delete;
+    RangeTree &operator=(const RangeTree &) = delete;
+
+    // Builds over values[0, n).  False if the arena is out of memory.
+    bool build(ColumnArena &store, const T *values, int n) {
+        n_ = n < 0 ? 0 : n;
+        h_ = 0;
+        while (h_ < 31 && (1LL << h_) <= n_) h_++;
+        dirty_ = false;
+        store.reserve(t_, 2 * (size_t) n_);
+        store.reserve(pend_, (size_t) n_);
+        if (!store.commit()) return false;
+        for (int i = 0; i < n_; i++) t_[n_ + i] = Agg{values[i], values[i], values[i]};
+        for (int i = n_ - 1; i > 0; i--) t_[i] = combine(t_[2 * i], t_[2 * i + 1]);
+        return true;
+    }
+
+    int size() const { return n_; }
+
+    // Updates on [l, r); empty or reversed ranges do nothing.
+    void add(int l, int r, T x) { modify(l, r, ADD, x); }
+    void assign(int l, int r, T x) { modify(l, r, ASSIGN, x); }
+    void set(int i, T x) { modify(i, i + 1, ASSIGN, x); }
+
+    // Aggregate of [l, r); an empty range gives sum 0, min above max.
+    Agg query(int l, int r) {
+        if (l < 0) l = 0;
+        if (r > n_) r = n_;
+        Agg res = empty();
+        if (l >= r) return res;
+        l += n_;
+        r += n_;
+        if (dirty_) {
+            push(l);
+            push(r - 1);
+        }
+        for (; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) res = combine(res, t_[l++]);
+            if (r & 1) res = combine(res, t_[--r]);
+        }
+        return res;
+    }
+
+    T get(int i) { return query(i, i + 1).sum; }
+
+    // Answers the ranges [l[j], r[j]) into out[j].  A batch big enough to
+    // pay for it first pushes every pending update down in one O(n) pass,
+    // after which the queries are plain bottom-up walks.
+    void queryBatch(const int *l, const int *r, int q, Agg *out) {
+        if (dirty_ && (long long) q * h_ >= n_) flush();
+        for (int j = 0; j < q; j++) out[j] = query(l[j], r[j]);
+    }
+
+    // Pushes every pending update to the leaves.
+    void flush() {
+        for (int i = 1; i < n_; i++) {
+            if (!pend_[i].op) continue;
+            // leaves under each child of i
+            long long k = 1;
+            for (long long c = 2 * i; c < n_; c *= 2) k *= 2;
+            pushNode(i, k);
+        }
+        dirty_ = false;
+    }
+
+private:
+    enum : unsigned char { NONE = 0, ADD = 1, ASSIGN = 2 };
+    struct Pending { T x; unsigned char op; };     // op not yet passed to the children
+
+    static Agg empty() {
+        return Agg{T(0), std::numeric_limits<T>::max(), std::numeric_limits<T>::lowest()};
+    }
+    static Agg combine(const Agg &a, const Agg &b) {
+        return Agg{a.sum + b.sum, b.min < a.min ? b.min : a.min, a.max < b.max ? b.max : a.max};
+    }
+    // op on a node covering k leaves, aggregate only
+    static void applyAgg(Agg &a, unsigned char op, T x, long long k) {
+        if (op == ASSIGN) {
+            a.sum = x * (T) k;
+            a.min = a.max = x;
+        } else {
+            a.sum += x * (T) k;
+            a.min += x;
+            a.max += x;
+        }
+    }
+
+    // op on node i covering k leaves; internal nodes remember it for their children
+    void apply(int i, unsigned char op, T x, long long k) {
+        applyAgg(t_[i], op, x, k);
+        if (i >= n_) return;
+        Pending &p = pend_[i];
+        if (op == ASSIGN || !p.op) {
+            p.op = op;
+            p.x = x;
+        } else {
+            p.x += x;           // add after add or assign
+        }
+    }
+
+    // hands i's pending op to its children, each covering k leaves
+    void pushNode(int i, long long k) {
+        apply(2 * i, pend_[i].op, pend_[i].x, k);
+        apply(2 * i + 1, pend_[i].op, pend_[i].x, k);
+        pend_[i].op = NONE;
+    }
+
+    // clears the pending ops on the path from the root to leaf p
+    void push(int p) {
+        for (int s = h_; s > 0; s--) {
+            int i = p >> s;
+            if (i > 0 && pend_[i].op) pushNode(i, 1LL << (s - 1));
+        }
+    }
+
+    // recomputes the ancestors of p, keeping their own pending ops
+    void pull(int p) {
+        long long k = 1;
+        while (p > 1) {
+            p >>= 1;
+            k *= 2;
+            t_[p] = combine(t_[2 * p], t_[2 * p + 1]);
+            if (pend_[p].op) applyAgg(t_[p], pend_[p].op, pend_[p].x, k);
+        }
+    }
+
+    void modify(int l, int r, unsigned char op, T x) {
+        if (l < 0) l = 0;
+        if (r > n_) r = n_;
+        if (l >= r) return;
+        l += n_;
+        r += n_;
+        push(l);
+        push(r - 1);
+        int l0 = l, r0 = r;
+        for (long long k = 1; l < r; l >>= 1, r >>= 1, k *= 2) {
+            if (l & 1) apply(l++, op, x, k);
+            if (r & 1) apply(--r, op, x, k);
+        }
+        pull(l0);
+        pull(r0 - 1);
+        dirty_ = true;
+    }
+
+    int n_ = 0, h_ = 0;
+    bool dirty_ = false;        // some internal node holds a pending op
+    Agg *t_ = nullptr;          // 2 * n_ nodes, leaves at [n_, 2 * n_)
+    Pending *pend_ = nullptr;   // per internal node
+};
+
+} // namespace samarthaka
+
+#endif
@@ -0,0 +1,314 @@
+// series_store.h
+// Compressed per-meter time series with range-over-time sums.
+//
+// Readings (series, time, value) are grouped per series into blocks, one
+// block per time bucket (say a day of 15-minute readings), and each block
+// is packed as byte varints: times as zigzag delta-of-delta (a regular
+// interval costs one byte), values as zigzag deltas.  Next to the blocks
+// sit a per-series block index (bucket, offset, count, running sum) and a
+// two-dimensional Fenwick tree of slot totals over (slot, series), a slot
+// being a finer step that divides the bucket (say the reading interval).
+// Only slots that hold readings get a Fenwick row, so one stray timestamp
+// (epoch 0, a typo'd year) adds a row rather than every slot in between;
+// query bounds are mapped to rows by binary search.
+//
+//   samarthaka::SeriesStore usage;
+//   usage.build(store, meter, time, wh, rows, meters, 86400, 900);
+//   long long wh = usage.sum(100, 250, jan1, feb1);    // meters [100, 250)
+//
+// A sum is O(log R * log S) from the Fenwick tree, R being the slots with
+// readings, when each end of the range falls on a slot boundary or cuts a
+// slot whose readings all lie on one side of it (each row keeps its first
+// and last reading time).  Only an end that splits a slot's readings
+// decodes that one block of each series in range.  The tree costs eight
+// bytes per (slot, series), about one per reading when the slot is the
+// reading interval.  Arrays come out of the caller's ColumnArena.
+
+#ifndef SAMARTHAKA_SERIES_STORE_H
+#define SAMARTHAKA_SERIES_STORE_H
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+
+#include "column_arena.h"
+
+namespace samarthaka {
+
+class SeriesStore {
+public:
+    SeriesStore() {}
+    SeriesStore(const SeriesStore &) = delete;
+    SeriesStore &operator=(const SeriesStore &) = delete;
+
+    // Builds from n readings: series[i] in [0, seriesCount), time[i] in
+    // seconds, value[i].  Readings may come in any order; ones with a
+    // series out of range are skipped.  slotSeconds must divide
+    // bucketSeconds; otherwise (or 0) slots are whole buckets.  False if out
+    // of memory.
+    bool build(ColumnArena &store, const int *series, const long long *time, const long long *value,
+               size_t n, int seriesCount, long long bucketSeconds, long long slotSeconds = 0) {
+        ns_ = seriesCount < 0 ? 0 : seriesCount;
+        width_ = bucketSeconds < 1 ? 1 : bucketSeconds;
+        slotW_ = slotSeconds >= 1 && width_ % slotSeconds == 0 ? slotSeconds : width_;
+        readings_ = 0;
+        bytes_ = 0;
+
+        // readings sorted by (series, time)
+        size_t *ord;
+        store.reserve(ord, n);
+        store.reserve(blockStart_, (size_t) ns_ + 1);
+        if (!store.commit()) return false;
+        for (size_t i = 0; i < n; i++)
+            if (series[i] >= 0 && series[i] < ns_) ord[readings_++] = i;
+        std::sort(ord, ord + readings_, [&](size_t a, size_t b) {
+            return series[a] != series[b] ? series[a] < series[b] : time[a] < time[b];
+        });
+
+        // the slots that hold readings, ascending, and the buckets they fall in
+        long long *slots;
+        store.reserve(slots, readings_);
+        if (!store.commit()) return false;
+        for (size_t i = 0; i < readings_; i++) slots[i] = floorDiv(time[ord[i]], slotW_);
+        std::sort(slots, slots + readings_);
+        nr_ = (int) (std::unique(slots, slots + readings_) - slots);
+        slot_ = slots;
+        store.reserve(day_, (size_t) nr_);
+        store.reserve(slotFirst_, (size_t) nr_);
+        store.reserve(slotLast_, (size_t) nr_);
+        if (!store.commit()) return false;
+        nb_ = 0;
+        for (int r = 0; r < nr_; r++) {
+            long long d = floorDiv(slot_[r] * slotW_, width_);
+            if (nb_ == 0 || day_[nb_ - 1] != d) day_[nb_++] = d;
+            slotFirst_[r] = LLONG_MAX;
+            slotLast_[r] = LLONG_MIN;
+        }
+        tmin_ = readings_ ? day_[0] * width_ : 0;
+        tend_ = readings_ ? day_[nb_ - 1] * width_ + width_ : 0;
+
+        // pass 1: blocks per series and packed size
+        int blocks = 0;
+        for (size_t i = 0; i < readings_; i++) {
+            bool first = i == 0 || series[ord[i]] != series[ord[i - 1]] ||
+                         floorDiv(time[ord[i]], width_) != floorDiv(time[ord[i - 1]], width_);
+            if (first) {
+                blocks++;
+                blockStart_[series[ord[i]] + 1]++;
+            }
+        }
+        for (int s = 0; s < ns_; s++) blockStart_[s + 1] += blockStart_[s];
+        for (int pass = 0; pass < 2; pass++) {
+            if (pass == 1) {
+                store.reserve(data_, bytes_ + 1);
+                store.reserve(blkBucket_, (size_t) blocks);
+                store.reserve(blkOffset_, (size_t) blocks);
+                store.reserve(blkCount_, (size_t) blocks);
+                store.reserve(blkRunning_, (size_t) blocks);
+                store.reserve(fen_, (size_t) (nr_ + 1) * (ns_ + 1));
+                if (!store.commit()) return false;
+            }
+            // pass 0 only measures, pass 1 writes
+            Writer w{pass == 1 ? data_ : nullptr, 0};
+            int blk = -1;
+            long long prevTime = 0, prevDelta = 0, prevValue = 0, running = 0;
+            for (size_t i = 0; i < readings_; i++) {
+                size_t r = ord[i];
+                int s = series[r];
+                long long t = time[r], v = value[r];
+                if (i == 0 || s != series[ord[i - 1]]) running = 0;
+                if (i == 0 || s != series[ord[i - 1]] ||
+                    floorDiv(t, width_) != floorDiv(time[ord[i - 1]], width_)) {
+                    blk++;
+                    int b = bucket(t);
+                    if (pass == 1) {
+                        blkBucket_[blk] = b;
+                        blkOffset_[blk] = w.at;
+                        blkCount_[blk] = 0;
+                    }
+                    w.put((uint64_t) (t - day_[b] * width_));
+                    w.put(zigzag(v));
+                    prevDelta = 0;
+                } else {
+                    long long delta = t - prevTime;
+                    w.put(zigzag(delta - prevDelta));
+                    w.put(zigzag(v - prevValue));
+                    prevDelta = delta;
+                }
+                prevTime = t;
+                prevValue = v;
+                running += v;
+                if (pass == 1) {
+                    blkCount_[blk]++;
+                    blkRunning_[blk] = running;
+                    int row = lowerSlot(floorDiv(t, slotW_));
+                    slotFirst_[row] = std::min(slotFirst_[row], t);
+                    slotLast_[row] = std::max(slotLast_[row], t);
+                    cell(row + 1, s + 1) += v;
+                }
+            }
+            bytes_ = w.at;
+        }
+
+        // Fenwick in place: along series within each slot row, then along slots
+        for (int r = 1; r <= nr_; r++)
+            for (int s = 1; s <= ns_; s++) {
+                int up = s + (s & -s);
+                if (up <= ns_) cell(r, up) += cell(r, s);
+            }
+        for (int r = 1; r <= nr_; r++) {
+            int up = r + (r & -r);
+            if (up > nr_) continue;
+            for (int s = 1; s <= ns_; s++) cell(up, s) += cell(r, s);
+        }
+        return true;
+    }
+
+    int series() const { return ns_; }
+    int buckets() const { return nb_; }
+    int slots() const { return nr_; }
+    size_t readings() const { return readings_; }
+    size_t bytes() const { return bytes_; }         // packed readings, without the indexes
+
+    // Sum of the values of series [s0, s1) with time in [t0, t1).
+    long long sum(int s0, int s1, long long t0, long long t1) const {
+        s0 = std::max(s0, 0);
+        s1 = std::min(s1, ns_);
+        if (s0 >= s1 || t0 >= t1 || nb_ == 0) return 0;
+        t0 = std::max(t0, tmin_);
+        t1 = std::min(t1, tend_);
+        if (t0 >= t1) return 0;
+        // slot rows [r0, r1) touch the range; only the end rows can be cut
+        int r0 = lowerSlot(floorDiv(t0, slotW_)), r1 = lowerSlot(floorDiv(t1 - 1, slotW_) + 1);
+        long long total = 0;
+        if (r0 < r1 && !within(r0, t0, t1)) total += ragged(r0++, s0, s1, t0, t1);
+        if (r0 < r1 && !within(r1 - 1, t0, t1)) total += ragged(--r1, s0, s1, t0, t1);
+        if (r0 < r1) total += prefix(r1, s1) - prefix(r0, s1) - prefix(r1, s0) + prefix(r0, s0);
+        return total;
+    }
+
+    // Sum of one series over [t0, t1): whole blocks from the running sums,
+    // at most two blocks decoded.
+    long long seriesSum(int s, long long t0, long long t1) const {
+        if (s < 0 || s >= ns_ || t0 >= t1) return 0;
+        int lo = blockStart_[s], hi = blockStart_[s + 1];
+        if (lo == hi) return 0;
+        int first = lowerBlock(lo, hi, lowerDay(floorDiv(t0, width_)));
+        int last = lowerBlock(lo, hi, lowerDay(floorDiv(t1 - 1, width_) + 1)) - 1;
+        if (first > last) return 0;
+        long long total = partial(s, first, t0, t1);
+        if (last == first) return total;
+        total += partial(s, last, t0, t1);
+        if (last - 1 > first) total += blkRunning_[last - 1] - blkRunning_[first];
+        return total;
+    }
+
+private:
+    struct Writer {
+        uint8_t *out;
+        size_t at;
+        void put(uint64_t x) {
+            while (x >= 0x80) {
+                if (out) out[at] = (uint8_t) (x | 0x80);
+                at++;
+                x >>= 7;
+            }
+            if (out) out[at] = (uint8_t) x;
+            at++;
+        }
+    };
+
+    static uint64_t zigzag(long long x) { return ((uint64_t) x << 1) ^ (uint64_t) (x >> 63); }
+    static long long unzigzag(uint64_t x) { return (long long) (x >> 1) ^ -(long long) (x & 1); }
+    static long long floorDiv(long long a, long long b) { return a / b - (a % b != 0 && (a < 0) != (b < 0)); }
+    static uint64_t get(const uint8_t *&p) {
+        uint64_t x = 0;
+        for (int shift = 0;; shift += 7) {
+            uint8_t c = *p++;
+            x |= (uint64_t) (c & 0x7f) << shift;
+            if (c < 0x80) return x;
+        }
+    }
+
+    // first bucket at or after day d
+    int lowerDay(long long d) const { return (int) (std::lower_bound(day_, day_ + nb_, d) - day_); }
+    // bucket of t, which must hold readings
+    int bucket(long long t) const { return lowerDay(floorDiv(t, width_)); }
+    // first slot row at or after slot k
+    int lowerSlot(long long k) const { return (int) (std::lower_bound(slot_, slot_ + nr_, k) - slot_); }
+
+    long long &cell(int r, int s) const { return fen_[(size_t) r * (ns_ + 1) + s]; }
+
+    // every reading of slot row r lies in [t0, t1)
+    bool within(int r, long long t0, long long t1) const { return slotFirst_[r] >= t0 && slotLast_[r] < t1; }
+
+    // Slot row r's share of series [s0, s1) over [t0, t1): nothing if its
+    // readings all miss the range, else one block decoded per series.
+    long long ragged(int r, int s0, int s1, long long t0, long long t1) const {
+        if (slotLast_[r] < t0 || slotFirst_[r] >= t1) return 0;
+        t0 = std::max(t0, slot_[r] * slotW_);
+        t1 = std::min(t1, slot_[r] * slotW_ + slotW_);
+        long long total = 0;
+        for (int s = s0; s < s1; s++) total += seriesSum(s, t0, t1);
+        return total;
+    }
+
+    // sum over slot rows [0, r) and series [0, s)
+    long long prefix(int r, int s) const {
+        long long total = 0;
+        for (int i = r; i > 0; i -= i & -i)
+            for (int j = s; j > 0; j -= j & -j) total += cell(i, j);
+        return total;
+    }
+
+    // first block in [lo, hi) with bucket >= b
+    int lowerBlock(int lo, int hi, int b) const {
+        return (int) (std::lower_bound(blkBucket_ + lo, blkBucket_ + hi, b) - blkBucket_);
+    }
+
+    // Sum of block k (of series s) over [t0, t1).  Decoding stops at the
+    // later bound, so a range running past the block's end is taken as the
+    // block total minus the readings before t0.
+    long long partial(int s, int k, long long t0, long long t1) const {
+        long long start = day_[blkBucket_[k]] * width_;
+        if (t1 < start + width_) return decode(k, t0, t1);
+        long long total = blkRunning_[k] - (k > blockStart_[s] ? blkRunning_[k - 1] : 0);
+        return t0 <= start ? total : total - decode(k, LLONG_MIN, t0);
+    }
+
+    // sum of block k's readings with time in [t0, t1)
+    long long decode(int k, long long t0, long long t1) const {
+        const uint8_t *p = data_ + blkOffset_[k];
+        long long t = day_[blkBucket_[k]] * width_ + (long long) get(p);
+        long long v = unzigzag(get(p)), delta = 0, total = 0;
+        for (int i = 0;; ) {
+            if (t >= t1) break;
+            if (t >= t0) total += v;
+            if (++i == blkCount_[k]) break;
+            delta += unzigzag(get(p));
+            t += delta;
+            v += unzigzag(get(p));
+        }
+        return total;
+    }
+
+    int ns_ = 0, nb_ = 0, nr_ = 0;
+    long long width_ = 1, slotW_ = 1;
+    long long tmin_ = 0, tend_ = 0;     // [start of the first bucket, end of the last)
+    size_t readings_ = 0, bytes_ = 0;
+    int *blockStart_ = nullptr;         // ns_ + 1: blocks of series s are [blockStart_[s], blockStart_[s + 1])
+    long long *day_ = nullptr;          // nb_ buckets with readings, as floor(time / width_)
+    long long *slot_ = nullptr;         // nr_ slots with readings, as floor(time / slotW_)
+    long long *slotFirst_ = nullptr;    // per slot row, first and last reading time
+    long long *slotLast_ = nullptr;
+    int *blkBucket_ = nullptr;          // per block, index into day_
+    size_t *blkOffset_ = nullptr;       // into data_
+    int *blkCount_ = nullptr;
+    long long *blkRunning_ = nullptr;   // sum of the series up to and including this block
+    uint8_t *data_ = nullptr;
+    long long *fen_ = nullptr;          // (nr_ + 1) x (ns_ + 1), 1-based Fenwick over (slot, series)
+};
+
+} // namespace samarthaka
+
+#endif
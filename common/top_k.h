@@ -0,0 +1,135 @@
+// top_k.h
+// Bounded top-K selection for the Samarthaka tools.
+//
+// Keeps the K largest keys seen so far in a fixed-size min-heap: O(log K)
+// per offer, no allocation, so a full pass is O(N log K).  Keys compare
+// with operator<; make them unique (e.g. std::pair<value, row>) when ties
+// must come out in a fixed order.
+//
+//   samarthaka::TopK<std::pair<int,int>, int, 10> top;
+//   for (int i = 0; i < n; i++) top.offer({Pop[i], i}, i);
+//   int rows[10];
+//   int k = top.sorted(nullptr, rows);          // largest first
+//
+// Streaming: when a value changes later, update() moves a member or lets
+// an outsider in.  If a member's key drops below the best key that was
+// ever left out, some outsider might now belong in the top K; update()
+// then returns false and the caller rebuilds from its data.
+
+#ifndef SAMARTHAKA_TOP_K_H
+#define SAMARTHAKA_TOP_K_H
+
+namespace samarthaka {
+
+template <class Key, class Payload, int K>
+class TopK {
+public:
+    TopK() { clear(); }
+
+    void clear() {
+        n_ = 0;
+        hasFloor_ = false;
+    }
+
+    int size() const { return n_; }
+
+    // Smallest key currently kept (valid when size() > 0).
+    const Key &min() const { return key_[0]; }
+
+    // Offers an item that is not in the selection yet.
+    void offer(const Key &key, const Payload &payload) {
+        if (n_ < K) {
+            key_[n_] = key;
+            val_[n_] = payload;
+            siftUp(n_++);
+            return;
+        }
+        if (!(key_[0] < key)) {
+            raiseFloor(key);
+            return;
+        }
+        raiseFloor(key_[0]);
+        key_[0] = key;
+        val_[0] = payload;
+        siftDown(0);
+    }
+
+    // payload's key changed to key.  O(K) lookup, then O(log K).
+    // Returns false when the selection can no longer be trusted.
+    bool update(const Key &key, const Payload &payload) {
+        for (int i = 0; i < n_; i++) {
+            if (!(val_[i] == payload)) continue;
+            bool dropped = key < key_[i];
+            key_[i] = key;
+            if (dropped) siftUp(i);
+            else siftDown(i);
+            return !(dropped && hasFloor_ && key < floor_);
+        }
+        offer(key, payload);
+        return true;
+    }
+
+    // Copies the selection out, largest key first; either array may be
+    // null.  Returns the number of items.
+    int sorted(Key *keys, Payload *payloads) const {
+        Key k[K];
+        Payload v[K];
+        int n = n_;
+        for (int i = 0; i < n; i++) { k[i] = key_[i]; v[i] = val_[i]; }
+        // insertion sort: K is small
+        for (int i = 1; i < n; i++) {
+            Key tk = k[i];
+            Payload tv = v[i];
+            int j = i;
+            while (j > 0 && k[j - 1] < tk) { k[j] = k[j - 1]; v[j] = v[j - 1]; j--; }
+            k[j] = tk;
+            v[j] = tv;
+        }
+        for (int i = 0; i < n; i++) {
+            if (keys) keys[i] = k[i];
+            if (payloads) payloads[i] = v[i];
+        }
+        return n;
+    }
+
+private:
+    void raiseFloor(const Key &key) {
+        if (!hasFloor_ || floor_ < key) floor_ = key;
+        hasFloor_ = true;
+    }
+
+    void swapAt(int a, int b) {
+        Key tk = key_[a]; key_[a] = key_[b]; key_[b] = tk;
+        Payload tv = val_[a]; val_[a] = val_[b]; val_[b] = tv;
+    }
+
+    void siftUp(int i) {
+        while (i > 0) {
+            int p = (i - 1) / 2;
+            if (!(key_[i] < key_[p])) break;
+            swapAt(i, p);
+            i = p;
+        }
+    }
+
+    void siftDown(int i) {
+        while (true) {
+            int l = 2 * i + 1, r = l + 1, m = i;
+            if (l < n_ && key_[l] < key_[m]) m = l;
+            if (r < n_ && key_[r] < key_[m]) m = r;
+            if (m == i) break;
+            swapAt(i, m);
+            i = m;
+        }
+    }
+
+    Key key_[K];
+    Payload val_[K];
+    int n_;
+    Key floor_;            // largest key ever left out of the selection
+    bool hasFloor_;
+};
+
+} // namespace samarthaka
+
+#endif
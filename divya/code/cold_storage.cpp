@@ -1,5 +1,6 @@
 
 #include <bits/stdc++.h>
+#include "../../common/csv_mmap.h"
 using namespace std;
 
 /* ==========================
@@ -7,19 +8,18 @@ using namespace std;
    ========================== */
 vector<vector<string>> readCSV(const string& filename) {
     vector<vector<string>> data;
-    ifstream file(filename);
-    string line, cell;
-    if (!file.is_open()) {
+    samarthaka::CsvReader csv(filename.c_str(), samarthaka::CSV_KEEP_HEADER);
+    if (!csv.ok()) {
         cerr << "Error opening file: " << filename << endl;
         exit(EXIT_FAILURE);
     }
-    while (getline(file, line)) {
-        stringstream ss(line);
+    csv.forEachRow([&](const samarthaka::CsvRow &fields) {
         vector<string> row;
-        while (getline(ss, cell, ','))
-            row.push_back(cell);
-        data.push_back(row);
-    }
+        row.reserve(fields.size());
+        for (int i = 0; i < fields.size(); i++)
+            row.emplace_back(fields[i]);
+        data.push_back(move(row));
+    });
     return data;
 }
 
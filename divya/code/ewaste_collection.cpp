@@ -1,4 +1,5 @@
 #include <bits/stdc++.h>
+#include "../../common/csv_mmap.h"
 using namespace std;
 
 /* ==========================
@@ -6,23 +7,20 @@ using namespace std;
    ========================== */
 vector<vector<string>> readCSV(const string& filename) {
     vector<vector<string>> data;
-    ifstream file(filename);
-    string line, cell;
+    samarthaka::CsvReader csv(filename.c_str(), samarthaka::CSV_KEEP_HEADER);
 
-    if (!file.is_open()) {
+    if (!csv.ok()) {
         cout << "Error opening file: " << filename << endl;
         exit(1);
     }
 
-    while (getline(file, line)) {
-        stringstream ss(line);
+    csv.forEachRow([&](const samarthaka::CsvRow &fields) {
         vector<string> row;
-        while (getline(ss, cell, ',')) {
-            row.push_back(cell);
-        }
-        data.push_back(row);
-    }
-    file.close();
+        row.reserve(fields.size());
+        for (int i = 0; i < fields.size(); i++)
+            row.emplace_back(fields[i]);
+        data.push_back(move(row));
+    });
     return data;
 }
 
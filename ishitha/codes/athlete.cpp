@@ -1,45 +1,35 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cstdlib>
+
+#include "../../common/csv_mmap.h"
+
 using namespace std;
 
-const int MAXR = 10050;
 const int HSIZE = 20011;
 
-/* CSV arrays */
-int AthleteID[MAXR];
-int Speed[MAXR];
-int Endurance[MAXR];
-int Strength[MAXR];
-int Score[MAXR];
-char Pattern[MAXR][30];
+/* CSV arrays: sized from the file by loadCSV */
+samarthaka::ColumnArena store;
+int *AthleteID;
+int *Speed;
+int *Endurance;
+int *Strength;
+int *Score;
+char (*Pattern)[30];
 
 int ROWS = 0;
 
 /* ================= CSV LOADING ================= */
 void loadCSV(const char* file) {
-    ifstream fin(file);
-    if (!fin) { cout<<"CSV not found\n"; exit(1); }
-
-    string line;
-    getline(fin, line);
-
-    while (getline(fin, line) && ROWS < MAXR-1) {
-        string tok;
-        stringstream ss(line);
-
-        getline(ss, tok, ','); AthleteID[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Speed[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Endurance[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Strength[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Score[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); strcpy(Pattern[ROWS], tok.c_str());
-
-        ROWS++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, AthleteID);
+    csv.bind(1, Speed);
+    csv.bind(2, Endurance);
+    csv.bind(3, Strength);
+    csv.bind(4, Score);
+    csv.bind(5, Pattern);
+    ROWS = csv.load(file, store, samarthaka::CSV_SNAPSHOT);
+    if (ROWS < 0) { cout<<csv.error()<<"\n"; exit(1); }
 }
 
 /* ================= HASH TABLE ================= */
@@ -77,11 +67,12 @@ int findHash(int id){
 /* ================= FENWICK TREE ================= */
 struct Fenwick {
     int n;
-    int bit[MAXR];
+    int *bit;
 
     void init(int N){
         n=N;
-        for(int i=0;i<=n;i++) bit[i]=0;
+        store.reserve(bit, n+1);
+        if(!store.commit()){ cout<<"Out of memory for "<<n<<" rows\n"; exit(1); }
     }
 
     void add(int i, int v){
@@ -133,13 +124,12 @@ bool KMP(const char* text, const char* pat){
 }
 
 /* ================= MERGE SORT (Ranking) ================= */
+int *L, *R, *Li, *Ri;   // merge scratch, ROWS each
+
 void merge(int* arr,int* idx,int l,int mid,int r){
     int n1=mid-l+1;
     int n2=r-mid;
 
-    int L[10050], R[10050];
-    int Li[10050], Ri[10050];
-
     for(int i=0;i<n1;i++){ L[i]=arr[l+i]; Li[i]=idx[l+i]; }
     for(int i=0;i<n2;i++){ R[i]=arr[mid+1+i]; Ri[i]=idx[mid+1+i]; }
 
@@ -174,7 +164,7 @@ int main(){
 
     /* HASH TABLE */
     cout<<"\n=== REAL-TIME DATA LOOKUP (Hash) ===\n";
-    for(int i=0;i<2000;i++) addHash(AthleteID[i], i);
+    for(int i=0;i<2000 && i<ROWS;i++) addHash(AthleteID[i], i);
     int idx = findHash(500);
     cout<<"Athlete 500 found at index: "<<idx<<"\n";
 
@@ -183,14 +173,14 @@ int main(){
     cout<<"\n=== PERFORMANCE TRACKING (Fenwick Tree) ===\n";
     fenw.init(ROWS);
     for(int i=1;i<=ROWS;i++) fenw.add(i, Score[i-1]);
-    cout<<"Total performance score of first 500 athletes = "<<fenw.sum(500)<<"\n";
+    cout<<"Total performance score of first 500 athletes = "<<fenw.sum(ROWS<500 ? ROWS : 500)<<"\n";
 
 
     /* KMP PATTERN MATCHING */
     cout<<"\n=== PATTERN RECOGNITION (KMP) ===\n";
     const char* findPat = "ABC";
     cout<<"Searching for pattern \"ABC\" in first 20 athletes...\n";
-    for(int i=0;i<20;i++){
+    for(int i=0;i<20 && i<ROWS;i++){
         bool ok = KMP(Pattern[i], findPat);
         cout<<"Athlete "<<AthleteID[i]<<" → "
             <<(ok?"MATCH":"NO MATCH")<<"\n";
@@ -199,7 +189,14 @@ int main(){
 
     /* MERGE SORT FOR RANKING */
     cout<<"\n=== ATHLETE RANKING (Merge Sort) ===\n";
-    int scoreArr[MAXR], idxArr[MAXR];
+    int *scoreArr, *idxArr;
+    store.reserve(scoreArr, ROWS);
+    store.reserve(idxArr, ROWS);
+    store.reserve(L, ROWS);
+    store.reserve(R, ROWS);
+    store.reserve(Li, ROWS);
+    store.reserve(Ri, ROWS);
+    if(!store.commit()){ cout<<"Out of memory for "<<ROWS<<" rows\n"; exit(1); }
 
     for(int i=0;i<ROWS;i++){
         scoreArr[i] = Score[i];
@@ -209,7 +206,7 @@ int main(){
     mergeSort(scoreArr, idxArr, 0, ROWS-1);
 
     cout<<"Top 10 ranked athletes:\n";
-    for(int i=0;i<10;i++){
+    for(int i=0;i<10 && i<ROWS;i++){
         int k = idxArr[i];
         cout<<i+1<<". Athlete "<<AthleteID[k]
             <<" Score="<<Score[k]<<"\n";
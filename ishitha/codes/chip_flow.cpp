@@ -4,12 +4,12 @@
 // Reads: samarthaka_chip_design.csv (in same folder)
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
 
+#include "../../common/csv_mmap.h"
+
 using namespace std;
 
 const int MAXROW = 10050;
@@ -31,26 +31,18 @@ int ROWS = 0;
 
 // ---------------- CSV loader ----------------
 void loadCSV(const char *fn) {
-    ifstream fin(fn);
-    if (!fin) { cerr << "Cannot open " << fn << "\n"; exit(1); }
-    string line;
-    getline(fin, line); // header
-    ROWS = 0;
-    while (getline(fin, line) && ROWS < MAXROW-2) {
-        stringstream ss(line);
-        string tok;
-        getline(ss, tok, ','); BlockID[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); strncpy(Type[ROWS], tok.c_str(), 15); Type[ROWS][15]=0;
-        getline(ss, tok, ','); Width[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); HeightA[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); ConnA[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); ConnB[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); WireLen[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Power_mW[ROWS] = atof(tok.c_str());
-        getline(ss, tok, ','); Temp_C[ROWS] = atof(tok.c_str());
-        ROWS++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, BlockID);
+    csv.bind(1, Type);
+    csv.bind(2, Width);
+    csv.bind(3, HeightA);
+    csv.bind(4, ConnA);
+    csv.bind(5, ConnB);
+    csv.bind(6, WireLen);
+    csv.bind(7, Power_mW);
+    csv.bind(8, Temp_C);
+    ROWS = csv.load(fn, MAXROW-2, samarthaka::CSV_SNAPSHOT);
+    if (ROWS < 0) { cerr << csv.error() << "\n"; exit(1); }
 }
 
 // ---------------- Backtracking demo (place small Nsmall blocks exactly into a tile grid) ----------------
@@ -1,9 +1,9 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cstdlib>
 
+#include "../../common/csv_mmap.h"
+
 using namespace std;
 
 const int MAXR = 10050;
@@ -23,27 +23,16 @@ int ROWS = 0;
 
 /* ---------- CSV Loader ---------- */
 void loadCSV(const char *fn){
-    ifstream fin(fn);
-    if(!fin){ cout<<"CSV not found!\n"; exit(1); }
-
-    string line;
-    getline(fin, line); // header
-
-    while(getline(fin, line) && ROWS < MAXR-2){
-        stringstream ss(line);
-        string t;
-
-        getline(ss,t,','); EventID[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); StartT[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); EndT[ROWS]   = atoi(t.c_str());
-        getline(ss,t,','); ResourceID[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); VenueA[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); VenueB[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); Cost[ROWS]   = atoi(t.c_str());
-
-        ROWS++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, EventID);
+    csv.bind(1, StartT);
+    csv.bind(2, EndT);
+    csv.bind(3, ResourceID);
+    csv.bind(4, VenueA);
+    csv.bind(5, VenueB);
+    csv.bind(6, Cost);
+    ROWS = csv.load(fn, MAXR-2, samarthaka::CSV_SNAPSHOT);
+    if(ROWS < 0){ cout<<csv.error()<<"\n"; exit(1); }
 }
 
 /* ===========================================================
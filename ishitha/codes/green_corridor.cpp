@@ -5,15 +5,16 @@
 // Reads samarthaka_greencorridor.csv in current folder.
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cstdlib>
+
+#include "../../common/csv_mmap.h"
+#include "../../common/csr_graph.h"
+
 using namespace std;
 
 const int MAXROW = 10050;        // support 10000+ rows
 const int MAXN   = 10050;        // nodes
-const int MAXE   = 400000;       // edges (bidirectional)
 const int INF    = 1000000000;
 
 // CSV arrays
@@ -26,54 +27,49 @@ int SignalStatus[MAXROW];
 int Blocked[MAXROW];
 int ROWS = 0;
 
-// Graph adjacency (arrays)
-int head[MAXN], toE[MAXE], costE[MAXE], nxtE[MAXE], ecnt;
-
-void initGraph(int n) {
-    for (int i=0;i<=n;i++) head[i] = -1;
-    ecnt = 0;
-}
+// Graph adjacency (CSR, nodes 0..maxNode; node 0 unused)
+samarthaka::ColumnArena store;
+samarthaka::CsrGraph road;
 
-void addEdgeOne(int u, int v, int w) {
-    if (ecnt >= MAXE) return;
-    toE[ecnt] = v;
-    costE[ecnt] = w;
-    nxtE[ecnt] = head[u];
-    head[u] = ecnt++;
+void addEdgeUndir(samarthaka::CsrGraph::Sink &arc, int u, int v, int w) {
+    if (u <= 0 || v <= 0) return;
+    arc(u,v,w);
+    arc(v,u,w);
 }
 
-void addEdgeUndir(int u, int v, int w) {
-    if (u <= 0 || v <= 0) return;
-    addEdgeOne(u,v,w);
-    addEdgeOne(v,u,w);
+// undirected edge to Conn1 / Conn2 of every row
+void buildGraph(int maxNode) {
+    bool ok = road.build(store, maxNode + 1, [](samarthaka::CsrGraph::Sink &arc) {
+        for (int i=0;i<ROWS;i++) {
+            int u = NodeID[i];
+            if (Conn1[i] > 0) addEdgeUndir(arc, u, Conn1[i], Time1A[i]);
+            if (Conn2[i] > 0) addEdgeUndir(arc, u, Conn2[i], Time2A[i]);
+        }
+    });
+    if (!ok) {
+        cerr << "Out of memory for the road graph\n";
+        exit(1);
+    }
 }
 
 // ------------------ CSV loader ------------------
 void loadCSV(const char *fn) {
-    ifstream fin(fn);
-    if (!fin) {
-        cerr << "Cannot open " << fn << "\n";
+    samarthaka::CsvBinding csv;
+    csv.bind(0, NodeID);
+    csv.bind(1, Lat);
+    csv.bind(2, Lon);
+    csv.bind(3, Conn1);
+    csv.bind(4, Time1A);
+    csv.bind(5, Conn2);
+    csv.bind(6, Time2A);
+    csv.bind(7, HospitalDist);
+    csv.bind(8, SignalStatus);
+    csv.bind(9, Blocked);
+    ROWS = csv.load(fn, MAXROW-2, samarthaka::CSV_SNAPSHOT);
+    if (ROWS < 0) {
+        cerr << csv.error() << "\n";
         exit(1);
     }
-    string line;
-    getline(fin, line); // header
-    ROWS = 0;
-    while (getline(fin, line) && ROWS < MAXROW-2) {
-        stringstream ss(line);
-        string tok;
-        getline(ss, tok, ','); NodeID[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Lat[ROWS] = atof(tok.c_str());
-        getline(ss, tok, ','); Lon[ROWS] = atof(tok.c_str());
-        getline(ss, tok, ','); Conn1[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Time1A[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Conn2[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Time2A[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); HospitalDist[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); SignalStatus[ROWS] = atoi(tok.c_str());
-        getline(ss, tok, ','); Blocked[ROWS] = atoi(tok.c_str());
-        ROWS++;
-    }
-    fin.close();
 }
 
 // ------------------ Dijkstra (min-heap) ------------------
@@ -130,8 +126,8 @@ void dijkstra(int src, int maxNode) {
         if (seenA[u]) continue;
         seenA[u] = true;
         // relax neighbors
-        for (int e = head[u]; e != -1; e = nxtE[e]) {
-            int v = toE[e], w = costE[e];
+        for (int e = road.begin(u); e < road.end(u); e++) {
+            int v = road.target(e), w = road.weight(e);
             if (distA[u] + w < distA[v]) {
                 distA[v] = distA[u] + w;
                 parentA[v] = u;
@@ -192,8 +188,8 @@ int bfs_shortest_by_signals(int start, int target, int maxNode) {
     while (qh < qt) {
         int u = qArr[qh++];
         if (u == target) return 1;
-        for (int e = head[u]; e != -1; e = nxtE[e]) {
-            int v = toE[e];
+        for (int e = road.begin(u); e < road.end(u); e++) {
+            int v = road.target(e);
             // we only visit signals that are clear (SignalStatus==1)
             if (!visitedB[v] && SignalStatus[v-1] == 1 && Blocked[v-1] == 0) {
                 visitedB[v] = true;
@@ -227,8 +223,8 @@ int countBlockedComponent(int start, int maxNode) {
     while (top) {
         int u = stackD[--top];
         count++;
-        for (int e = head[u]; e != -1; e = nxtE[e]) {
-            int v = toE[e];
+        for (int e = road.begin(u); e < road.end(u); e++) {
+            int v = road.target(e);
             if (!visitedD[v] && Blocked[v-1] == 1) {
                 visitedD[v] = true;
                 stackD[top++] = v;
@@ -250,12 +246,7 @@ int main() {
     if (maxNode >= MAXN) maxNode = MAXN-1;
 
     // Build graph (undirected). NodeIDs are assumed 1..maxNode
-    initGraph(maxNode);
-    for (int i=0;i<ROWS;i++) {
-        int u = NodeID[i];
-        if (Conn1[i] > 0) addEdgeUndir(u, Conn1[i], Time1A[i]);
-        if (Conn2[i] > 0) addEdgeUndir(u, Conn2[i], Time2A[i]);
-    }
+    buildGraph(maxNode);
 
     cout << "\n=== 1) ROUTE IDENTIFICATION & MAPPING (Dijkstra) ===\n";
     int src = 1;
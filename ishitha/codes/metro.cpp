@@ -4,105 +4,76 @@
 // Assumes CSV: samarthaka_metro.csv (format produced by your Python generator)
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
+#include <cstdlib>
+
+#include "../../common/csv_mmap.h"
+#include "../../common/csr_graph.h"
+
 using namespace std;
 
-const int MAXROW = 10000;
 const int MAXN = 300;
-const int MAXE = 40000; // increased to be safe (bidirectional edges)
 const int HASH_SIZE = 4096;
 const int INF = 1000000000;
 
-/* ---------------- CSV DATA ARRAYS ---------------- */
-int StationID[MAXROW], Neighbor1[MAXROW], Cost1[MAXROW];
-int Neighbor2[MAXROW], Cost2[MAXROW];
-int InitialPassengers[MAXROW], TapFare[MAXROW], TapTimeArr[MAXROW];
-unsigned long long CardID[MAXROW];
-int InitialBalance[MAXROW], FaultCode[MAXROW];
-char DepartureTimes[ MAXROW ][50];
+/* ---------------- CSV DATA ARRAYS (one per row, sized by loadCSV) ---------------- */
+samarthaka::ColumnArena store;
+int *StationID, *Neighbor1, *Cost1;
+int *Neighbor2, *Cost2;
+int *InitialPassengers, *TapFare, *TapTimeArr;
+unsigned long long *CardID;
+int *InitialBalance, *FaultCode;
+char (*DepartureTimes)[50];
 int rowCount = 0;
 
 /* ---------------- CSV LOADER ---------------- */
 void loadCSV(const char *file)
 {
-    ifstream fin(file);
-    if (!fin) { cout << "ERROR: Cannot open CSV\n"; exit(0); }
-
-    string line;
-    getline(fin, line); // header
-
-    rowCount = 0;
-    while (getline(fin, line) && rowCount < MAXROW)
-    {
-        stringstream ss(line);
-        string tmp;
-
-        getline(ss, tmp, ','); StationID[rowCount] = stoi(tmp);
-        getline(ss, tmp, ','); /* zone ignored */
-
-        getline(ss, tmp, ','); Neighbor1[rowCount] = stoi(tmp);
-        getline(ss, tmp, ','); Cost1[rowCount] = stoi(tmp);
-
-        getline(ss, tmp, ','); Neighbor2[rowCount] = stoi(tmp);
-        getline(ss, tmp, ','); Cost2[rowCount] = stoi(tmp);
-
-        getline(ss, tmp, ','); strncpy(DepartureTimes[rowCount], tmp.c_str(), 49);
-
-        getline(ss, tmp, ','); InitialPassengers[rowCount] = stoi(tmp);
-
-        getline(ss, tmp, ','); CardID[rowCount] = stoull(tmp);
-        getline(ss, tmp, ','); InitialBalance[rowCount] = stoi(tmp);
-
-        getline(ss, tmp, ','); TapFare[rowCount] = stoi(tmp);
-        getline(ss, tmp, ','); TapTimeArr[rowCount] = stoi(tmp);
-
-        getline(ss, tmp, ','); FaultCode[rowCount] = stoi(tmp);
-
-        rowCount++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, StationID);
+    /* column 1: zone ignored */
+    csv.bind(2, Neighbor1);
+    csv.bind(3, Cost1);
+    csv.bind(4, Neighbor2);
+    csv.bind(5, Cost2);
+    csv.bind(6, DepartureTimes);
+    csv.bind(7, InitialPassengers);
+    csv.bind(8, CardID);
+    csv.bind(9, InitialBalance);
+    csv.bind(10, TapFare);
+    csv.bind(11, TapTimeArr);
+    csv.bind(12, FaultCode);
+
+    rowCount = csv.load(file, store, samarthaka::CSV_SNAPSHOT);
+    if (rowCount < 0) { cout << "ERROR: " << csv.error() << "\n"; exit(0); }
 }
 
 /* ============================================================
-   1. DIJKSTRA — ROUTE TRAVEL (adjacency lists)
+   1. DIJKSTRA — ROUTE TRAVEL (CSR adjacency)
 ============================================================ */
-int head[MAXN], toE[MAXE], costE[MAXE], nxtE[MAXE], ec;
+samarthaka::CsrGraph metroGraph;
 int distArr[MAXN], parentArr[MAXN];
 bool used[MAXN];
 
-void initGraph(int n)
-{
-    ec = 0;
-    for (int i = 0; i <= n; i++) head[i] = -1;
-}
-
-void addEdgeOneWay(int u, int v, int w)
+void addEdgeUndirected(samarthaka::CsrGraph::Sink &arc, int u, int v, int w)
 {
-    if (ec >= MAXE) return;
-    toE[ec] = v;
-    costE[ec] = w;
-    nxtE[ec] = head[u];
-    head[u] = ec++;
-}
-
-void addEdgeUndirected(int u, int v, int w)
-{
-    if (u <= 0 || v <= 0) return;
-    addEdgeOneWay(u, v, w);
-    addEdgeOneWay(v, u, w);
+    if (u <= 0 || v <= 0 || u >= MAXN || v >= MAXN) return;
+    arc(u, v, w);
+    arc(v, u, w);
 }
 
 void buildGraph()
 {
-    initGraph(MAXN-1);
-    for (int i = 0; i < rowCount; ++i)
+    bool ok = metroGraph.build(store, MAXN, [](samarthaka::CsrGraph::Sink &arc)
     {
-        int s = StationID[i];
-        if (Neighbor1[i] > 0) addEdgeUndirected(s, Neighbor1[i], Cost1[i]);
-        if (Neighbor2[i] > 0) addEdgeUndirected(s, Neighbor2[i], Cost2[i]);
-    }
+        for (int i = 0; i < rowCount; ++i)
+        {
+            int s = StationID[i];
+            if (Neighbor1[i] > 0) addEdgeUndirected(arc, s, Neighbor1[i], Cost1[i]);
+            if (Neighbor2[i] > 0) addEdgeUndirected(arc, s, Neighbor2[i], Cost2[i]);
+        }
+    });
+    if (!ok) { cout << "ERROR: out of memory for the metro graph\n"; exit(0); }
 }
 
 void dijkstra(int src, int nStations)
@@ -125,9 +96,9 @@ void dijkstra(int src, int nStations)
         if (v == -1) break;
         used[v] = true;
 
-        for (int e = head[v]; e != -1; e = nxtE[e])
+        for (int e = metroGraph.begin(v); e < metroGraph.end(v); e++)
         {
-            int to = toE[e], w = costE[e];
+            int to = metroGraph.target(e), w = metroGraph.weight(e);
             if (distArr[v] + w < distArr[to])
             {
                 distArr[to] = distArr[v] + w;
@@ -1,62 +1,63 @@
 // grid_full.cpp
+// Compile: g++ -O2 -pthread power.cpp -o power
+// Run: ./power [--queries file|- [--method dijkstra|bidi|alt (default)|ch] [--paths]]
+//              [--outages file|-] [--contingency] [--meter-ops file|-]
+//              [--readings file [--usage file|-]] [--dispatch file|-]
 // Reads samarthaka_grid.csv (10000 rows), builds graph and runs:
-//  - Power-source max-heap selection
+//  - Power-source selection (indexed 4-ary max-heap, live re-prioritising)
 //  - Kruskal MST (Union-Find)
 //  - Dijkstra shortest path (min-heap implemented with arrays)
-//  - Segment tree (meter queries/updates)
+//  - Point-to-point queries: bidirectional Dijkstra, A* with landmarks,
+//    contraction hierarchy (built once, cached next to the CSV)
+//  - Segment tree (meter queries, range tariff updates)
+//  - Interval readings store: compressed per-meter series, usage over
+//    meter ranges and time windows
 //  - Outage detection (simulate disabling edges, use Union-Find)
+//  - Outage engine: bridges / N-1 and N-2 sweeps, batched failure scenarios
 //
-// NO std::vector used — static arrays sized to support up to 10050 nodes and ~200k edges.
+// NO std::vector used — every array is sized from the CSV row count and carved
+// out of one ColumnArena (see common/column_arena.h).
 
 // #include <bits/stdc++.h>
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <string>
 #include <cstring>
 #include <cstdlib>
 #include <cmath>
 #include <algorithm>
 #include <limits>
+#include <climits>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "../../common/csv_mmap.h"
+#include "../../common/csr_graph.h"
+#include "../../common/range_tree.h"
+#include "../../common/series_store.h"
 
 using namespace std;
 
-const int MAX_NODES = 10050;       // supports 10k comfortably
-const int MAX_EDGES = 200050;      // edge storage (undirected edges will use 2*rows)
 const int INF = 1000000000;
 
+// all node- and edge-sized arrays below live here (allocNodes)
+samarthaka::ColumnArena store;
+
 // ----------------------------- Data arrays -----------------------------
-int NodeID[MAX_NODES];
-char NodeType[MAX_NODES][32];
-int ConnectedTo[MAX_NODES];
-int LineResInt[MAX_NODES];        // rounded Resistance stored as int
-long long MeterMonth[MAX_NODES];
+int *NodeID;
+char (*NodeType)[32];
+int *ConnectedTo;
+int *LineResInt;                  // rounded Resistance stored as int
+long long *MeterMonth;
+int *PeakKW;                      // capacity of a generation row
+double *FailProb;
 
 int N = 0;   // number of nodes (rows)
 int E = 0;   // number of directed edges added to adjacency (for Dijkstra)
 int KR_E = 0; // number of edges for Kruskal (one per CSV row typically)
 
-// ----------------------------- CSV parse helper -----------------------------
-void splitCSVLine(const string &line, string out[], int &count) {
-    count = 0;
-    string cur;
-    bool inquotes = false;
-    for (size_t i = 0; i < line.size(); ++i) {
-        char c = line[i];
-        if (c == '"') {
-            inquotes = !inquotes;
-            continue;
-        }
-        if (c == ',' && !inquotes) {
-            out[count++] = cur;
-            cur.clear();
-        } else cur.push_back(c);
-    }
-    out[count++] = cur;
-}
-
 // ----------------------------- Edge store (for Kruskal) -----------------------------
-struct KEdge { int u,v,w; } KEdges[MAX_EDGES];
+struct KEdge { int u,v,w; } *KEdges;   // at most one per row
 int kedgeCount = 0;
 
 // comparator for sorting edges
@@ -65,15 +66,24 @@ bool cmpKEdge(const KEdge &a, const KEdge &b) {
 }
 
 // ----------------------------- Union-Find -----------------------------
-int uf_parent[MAX_NODES];
-int uf_rankv[MAX_NODES];
+int *uf_parent;
+int *uf_rankv;
 
 void uf_make(int n) {
     for (int i = 0; i < n; ++i) { uf_parent[i] = i; uf_rankv[i] = 0; }
 }
+// iterative, halving the path as it goes (no recursion depth on long chains)
 int uf_find(int x) {
-    if (uf_parent[x] == x) return x;
-    return uf_parent[x] = uf_find(uf_parent[x]);
+    while (uf_parent[x] != x) {
+        uf_parent[x] = uf_parent[uf_parent[x]];
+        x = uf_parent[x];
+    }
+    return x;
+}
+// same root without writing anything, so threads may share it between unions
+int uf_root(int x) {
+    while (uf_parent[x] != x) x = uf_parent[x];
+    return x;
 }
 void uf_union(int a,int b) {
     a = uf_find(a); b = uf_find(b);
@@ -83,25 +93,18 @@ void uf_union(int a,int b) {
     if (uf_rankv[a] == uf_rankv[b]) uf_rankv[a]++;
 }
 
-// ----------------------------- Adjacency for Dijkstra (static linked list) -----------------------------
-int head[MAX_NODES];
-int adj_to[MAX_EDGES];
-int adj_w[MAX_EDGES];
-int adj_next[MAX_EDGES];
-int adj_ptr = 0;
+// ----------------------------- Adjacency for Dijkstra (CSR) -----------------------------
+// Grids at least this big are renumbered (reverse Cuthill-McKee) so that
+// Dijkstra's per-node arrays are touched close together; smaller ones fit
+// in cache as they are.
+const int REORDER_MIN_NODES = 1 << 15;
 
-void addEdgeAdj(int u,int v,int w) {
-    if (adj_ptr >= MAX_EDGES-2) return;
-    adj_to[adj_ptr] = v;
-    adj_w[adj_ptr] = w;
-    adj_next[adj_ptr] = head[u];
-    head[u] = adj_ptr++;
-}
+samarthaka::CsrGraph grid;        // 2 directed edges per row, internal node ids
 
 // ----------------------------- Min-heap for Dijkstra (arrays) -----------------------------
-int heap_node[MAX_NODES];
-int heap_dist[MAX_NODES];
-int heap_pos[MAX_NODES]; // position in heap (or -1)
+int *heap_node;
+int *heap_dist;
+int *heap_pos; // position in heap (or -1)
 int heap_size = 0;
 
 void heapInit(int n) {
@@ -157,102 +160,284 @@ pair<int,int> heapPop() {
 }
 
 // ----------------------------- Segment tree -----------------------------
-long long seg[4 * MAX_NODES];
-
-void segBuild(int idx,int l,int r) {
-    if (l == r) { seg[idx] = MeterMonth[l]; return; }
-    int mid=(l+r)/2;
-    segBuild(idx*2, l, mid);
-    segBuild(idx*2+1, mid+1, r);
-    seg[idx] = seg[idx*2] + seg[idx*2+1];
-}
-void segUpdate(int idx,int l,int r,int pos,long long val) {
-    if (l == r) { seg[idx] = val; return; }
-    int mid=(l+r)/2;
-    if (pos <= mid) segUpdate(idx*2, l, mid, pos, val);
-    else segUpdate(idx*2+1, mid+1, r, pos, val);
-    seg[idx] = seg[idx*2] + seg[idx*2+1];
-}
-long long segQuery(int idx,int l,int r,int ql,int qr) {
-    if (qr < l || ql > r) return 0;
-    if (ql <= l && r <= qr) return seg[idx];
-    int mid=(l+r)/2;
-    return segQuery(idx*2, l, mid, ql, qr) + segQuery(idx*2+1, mid+1, r, ql, qr);
-}
-
-// ----------------------------- Max-heap for Power Sources -----------------------------
-struct Source { int id; char type[32]; int score; };
-Source srcHeap[512];
-int srcHeapSize = 0;
-
-void srcSwap(int a,int b) { Source t=srcHeap[a]; srcHeap[a]=srcHeap[b]; srcHeap[b]=t; }
-void srcHeapifyUp(int i) {
-    while (i>0) {
-        int p=(i-1)/2;
-        if (srcHeap[i].score > srcHeap[p].score) { srcSwap(i,p); i=p; }
-        else break;
+// Monthly meter readings by row: range add / assign (feeder-wide tariff
+// changes) and sum / min / max over a range, all O(log N).
+samarthaka::RangeTree<long long> meters;
+
+// Interval readings (--readings): one compressed series per grid row, with
+// day buckets and quarter-hour index slots, so a window on the reading grid
+// comes straight from the index with nothing decoded.
+const long long USAGE_BUCKET = 86400;
+const long long USAGE_SLOT = 900;
+samarthaka::SeriesStore usage;
+
+// ----------------------------- Power source queue -----------------------------
+// Generation rows (solar / wind / hydro) in an indexed 4-ary max-heap keyed
+// by row: src_pos[row] is the row's slot (or -1), so a plant's score can move
+// either way in O(log N) as its output changes.  Slots hold the row and its
+// score side by side; ties go to the lower row.
+const int SRC_ARITY = 4;
+int *src_node;
+int *src_key;
+int *src_pos;   // per row, slot in the heap (or -1)
+int src_size = 0;
+
+bool isSource(int i) {
+    return strcmp(NodeType[i], "SolarPlant") == 0 ||
+           strcmp(NodeType[i], "WindFarm") == 0 ||
+           strcmp(NodeType[i], "HydroPlant") == 0;
+}
+// expected output in kW: capacity times availability
+int sourceScore(int i) {
+    return (int) llround(PeakKW[i] * (1.0 - FailProb[i]));
+}
+
+bool srcAbove(int keyA, int nodeA, int keyB, int nodeB) {
+    return keyA != keyB ? keyA > keyB : nodeA < nodeB;
+}
+void srcPlace(int slot, int node, int key) {
+    src_node[slot] = node;
+    src_key[slot] = key;
+    src_pos[node] = slot;
+}
+// moves the hole at slot up until (node, key) fits, then fills it
+void srcSiftUp(int slot, int node, int key) {
+    while (slot > 0) {
+        int p = (slot - 1) / SRC_ARITY;
+        if (!srcAbove(key, node, src_key[p], src_node[p])) break;
+        srcPlace(slot, src_node[p], src_key[p]);
+        slot = p;
     }
+    srcPlace(slot, node, key);
 }
-void srcPush(Source s) {
-    srcHeap[srcHeapSize] = s;
-    srcHeapifyUp(srcHeapSize);
-    srcHeapSize++;
+void srcSiftDown(int slot, int node, int key) {
+    while (true) {
+        int c = slot * SRC_ARITY + 1, best = -1;
+        int end = min(c + SRC_ARITY, src_size);
+        for (; c < end; c++)
+            if (best < 0 || srcAbove(src_key[c], src_node[c], src_key[best], src_node[best])) best = c;
+        if (best < 0 || !srcAbove(src_key[best], src_node[best], key, node)) break;
+        srcPlace(slot, src_node[best], src_key[best]);
+        slot = best;
+    }
+    srcPlace(slot, node, key);
+}
+// inserts row node or moves it to its new score
+void srcSet(int node, int key) {
+    int slot = src_pos[node];
+    if (slot < 0) srcSiftUp(src_size++, node, key);
+    else if (srcAbove(key, node, src_key[slot], node)) srcSiftUp(slot, node, key);
+    else srcSiftDown(slot, node, key);
+}
+void srcRemove(int node) {
+    int slot = src_pos[node];
+    if (slot < 0) return;
+    src_pos[node] = -1;
+    if (--src_size == slot) return;
+    int last = src_node[src_size], key = src_key[src_size];
+    if (slot > 0 && srcAbove(key, last, src_key[(slot - 1) / SRC_ARITY], src_node[(slot - 1) / SRC_ARITY]))
+        srcSiftUp(slot, last, key);
+    else
+        srcSiftDown(slot, last, key);
 }
-Source srcTop() {
-    if (srcHeapSize==0) { Source s; s.id=-1; strcpy(s.type,"None"); s.score=-1; return s; }
-    return srcHeap[0];
+int srcTop() { return src_size ? src_node[0] : -1; }
+
+// ----------------------------- Node storage -----------------------------
+int *distArr;
+unsigned *distSeen;     // stamp of the query that set distArr[v]
+int *dijParent;
+int *pathBuf;
+
+void allocNodes(int n) {
+    store.reserve(NodeID, n);
+    store.reserve(NodeType, n);
+    store.reserve(ConnectedTo, n);
+    store.reserve(LineResInt, n);
+    store.reserve(MeterMonth, n);
+    store.reserve(PeakKW, n);
+    store.reserve(FailProb, n);
+    store.reserve(KEdges, n);
+    store.reserve(uf_parent, n);
+    store.reserve(uf_rankv, n);
+    store.reserve(heap_node, n);
+    store.reserve(heap_dist, n);
+    store.reserve(heap_pos, n);
+    store.reserve(distArr, n);
+    store.reserve(distSeen, n);
+    store.reserve(dijParent, n);
+    store.reserve(pathBuf, n);
+    store.reserve(src_node, n);
+    store.reserve(src_key, n);
+    store.reserve(src_pos, n);
+    if (!store.commit()) {
+        cerr << "Out of memory for " << n << " grid nodes\n";
+        exit(1);
+    }
+    heapInit(n);    // heap_pos starts all -1; runDijkstra leaves it that way
+    for (int i = 0; i < n; ++i) src_pos[i] = -1;
 }
 
 // ----------------------------- CSV loader -----------------------------
+void snapColumns(samarthaka::ColumnSnapshot &snap) {
+    snap.add(0, NodeID);
+    snap.add(1, NodeType);
+    snap.add(7, ConnectedTo);
+    snap.add(6, PeakKW);
+    snap.add(8, LineResInt);
+    snap.add(9, FailProb);
+    snap.add(11, MeterMonth);
+}
+
 void loadCSV(const char *fname) {
-    ifstream fin(fname);
-    if (!fin.is_open()) {
+    // quoted mode: '"' toggles quoting and is stripped, commas inside quotes are kept.
+    // Big exports are parsed in parallel chunks; idx is still the row's position in the file.
+    const unsigned flags = samarthaka::CSV_QUOTED | samarthaka::CSV_SKIP_STUBS;
+
+    samarthaka::CsvReader csv(fname, flags | samarthaka::CSV_PARALLEL);
+    if (!csv.ok()) {
         cerr << "Unable to open " << fname << "\n";
         exit(1);
     }
-    string line;
-    getline(fin, line); // header
-    int idx = 0;
-    string tokens[32];
-    while (getline(fin, line)) {
-        if ((int)line.size() < 2) continue;
-        int cnt;
-        splitCSVLine(line, tokens, cnt);
+
+    // size every array from samarthaka_grid.csv.snap, else from a row count
+    samarthaka::ColumnSnapshot probe(flags);
+    snapColumns(probe);
+    int rows = probe.rowsIn(fname, INT_MAX);
+    bool cached = rows >= 0;
+    if (!cached) rows = csv.countRows();
+    allocNodes(rows);
+
+    // reuse the snapshot while the CSV is unchanged
+    samarthaka::ColumnSnapshot snap(flags);
+    snapColumns(snap);
+    if (cached && snap.load(fname, INT_MAX, N)) return;
+
+    N = csv.forEachRowIndexed([](const samarthaka::CsvRow &row, int idx) {
+        int cnt = row.size();
         // Expecting at least 12 columns (see guidance)
-        // tokens[0]=NodeID, [1]=NodeType, [7]=ConnectedTo, [8]=LineResistance, [11]=MeterReadingMonthly
+        // [0]=NodeID, [1]=NodeType, [6]=PeakLoadKW, [7]=ConnectedTo, [8]=LineResistance,
+        // [9]=FailureProbability, [11]=MeterReadingMonthly
         int nodeid = 0;
-        try { nodeid = stoi(tokens[0]); }
-        catch(...) { nodeid = idx; }
+        if (!row.get(0, nodeid)) nodeid = idx;
         NodeID[idx] = nodeid;
-        string ttype = (cnt>1?tokens[1]:"Unknown");
-        strncpy(NodeType[idx], ttype.c_str(), sizeof(NodeType[idx])-1);
-        NodeType[idx][sizeof(NodeType[idx])-1]=0;
+        samarthaka::copyText(NodeType[idx], cnt>1 ? row[1] : string_view("Unknown"));
         int conn = 0;
-        if (cnt>7) {
-            try { conn = stoi(tokens[7]); } catch(...) { conn = 0; }
-        }
+        if (cnt>7 && !row.get(7, conn)) conn = 0;
         ConnectedTo[idx] = conn;
+        int peak = 0;
+        if (cnt>6 && !row.get(6, peak)) peak = 0;
+        PeakKW[idx] = peak;
+        double fail = 0;
+        if (cnt>9 && !row.get(9, fail)) fail = 0;
+        FailProb[idx] = min(1.0, max(0.0, fail));
         int rint = 1;
-        if (cnt>8) {
-            try {
-                float rf = stof(tokens[8]);
-                rint = max(1, (int)round(rf));
-            } catch(...) { rint = 1; }
-        }
+        float rf;
+        if (cnt>8 && row.get(8, rf)) rint = max(1, (int)round(rf));
         LineResInt[idx] = rint;
         long long month = 0;
-        if (cnt>11) {
-            try { month = stoll(tokens[11]); } catch(...) { month = 0; }
-        }
+        if (cnt>11 && !row.get(11, month)) month = 0;
         MeterMonth[idx] = month;
-        idx++;
-        if (idx >= MAX_NODES) break;
-    }
-    N = idx;
-    fin.close();
+    }, rows);
+    snap.save(fname, INT_MAX, N);
 }
 
 // ----------------------------- Kruskal MST -----------------------------
+// Grids with at least PARALLEL_MST_MIN_EDGES edges use filter-Kruskal:
+// partition the edges around a sampled pivot weight, solve the light side,
+// then set aside heavy edges whose ends are already joined and carry on
+// with the rest.  Only small ranges are ever sorted, and partitioning /
+// filtering run on all cores.  The MST weight is the same as plain
+// Kruskal's, and KEdges still holds every edge, lightest first.
+const int PARALLEL_MST_MIN_EDGES = 1 << 20;
+const int KRUSKAL_BASE = 1 << 12;           // ranges this small are sorted
+const int PARALLEL_MIN_RANGE = 1 << 16;     // smaller ones stay on one thread
+
+KEdge *kTmp;                // partition buffer (parallel mode only)
+unsigned char *kCls;        // class of each edge while partitioning
+int mstThreads = 1;
+int mstUsed = 0;            // MST edges so far
+long long mstTotal = 0;
+
+// runs work(t) for t in [0, threads), t = 0 on the calling thread
+template <class F>
+void parallelFor(int threads, F work) {
+    thread *pool = new thread[threads - 1];
+    for (int t = 1; t < threads; t++) pool[t - 1] = thread(work, t);
+    work(0);
+    for (int t = 1; t < threads; t++) pool[t - 1].join();
+    delete[] pool;
+}
+
+// Kruskal over KEdges[lo, hi), already in weight order
+void kruskalScan(int lo, int hi) {
+    for (int i = lo; i < hi && mstUsed < N-1; ++i) {
+        int u = KEdges[i].u, v = KEdges[i].v, w = KEdges[i].w;
+        if (uf_find(u) != uf_find(v)) {
+            uf_union(u,v);
+            mstUsed++;
+            mstTotal += w;
+        }
+    }
+}
+
+// Stable partition of KEdges[lo, hi) by cls(edge) in 0..3; end[c]
+// receives the end of class c.
+template <class C>
+void partitionEdges(int lo, int hi, C cls, int end[4]) {
+    int threads = hi - lo >= PARALLEL_MIN_RANGE ? mstThreads : 1;
+    int chunk = (hi - lo + threads - 1) / threads;
+    int (*at)[4] = new int[threads][4];
+    parallelFor(threads, [&](int t) {
+        int a = min(hi, lo + t * chunk), b = min(hi, a + chunk);
+        for (int c = 0; c < 4; c++) at[t][c] = 0;
+        for (int i = a; i < b; i++) at[t][kCls[i] = (unsigned char) cls(KEdges[i])]++;
+    });
+    // at[t][c] becomes where chunk t writes its class c edges
+    int pos = lo;
+    for (int c = 0; c < 4; c++) {
+        for (int t = 0; t < threads; t++) {
+            int n = at[t][c];
+            at[t][c] = pos;
+            pos += n;
+        }
+        end[c] = pos;
+    }
+    parallelFor(threads, [&](int t) {
+        int a = min(hi, lo + t * chunk), b = min(hi, a + chunk);
+        for (int i = a; i < b; i++) kTmp[at[t][kCls[i]]++] = KEdges[i];
+    });
+    parallelFor(threads, [&](int t) {
+        int a = min(hi, lo + t * chunk), b = min(hi, a + chunk);
+        if (a < b) memcpy(KEdges + a, kTmp + a, sizeof(KEdge) * (b - a));
+    });
+    delete[] at;
+}
+
+// median weight of an evenly spaced sample of KEdges[lo, hi)
+int samplePivot(int lo, int hi) {
+    int w[31];
+    for (int k = 0; k < 31; k++) w[k] = KEdges[lo + (long long) (hi - lo - 1) * k / 30].w;
+    nth_element(w, w + 15, w + 31);
+    return w[15];
+}
+
+void filterKruskal(int lo, int hi) {
+    while (hi - lo > KRUSKAL_BASE && mstUsed < N-1) {
+        int p = samplePivot(lo, hi), end[4], kept[4];
+        partitionEdges(lo, hi, [p](const KEdge &e) { return e.w < p ? 0 : e.w == p ? 1 : 2; }, end);
+        filterKruskal(lo, end[0]);
+        kruskalScan(end[0], end[1]);        // all of weight p
+        // heavy edges inside one tree already go to the back, unsorted
+        partitionEdges(end[1], end[2], [](const KEdge &e) { return uf_root(e.u) == uf_root(e.v) ? 3 : 0; }, kept);
+        lo = end[1];
+        hi = kept[0];
+    }
+    if (mstUsed < N-1) {
+        sort(KEdges + lo, KEdges + hi, cmpKEdge);
+        kruskalScan(lo, hi);
+    }
+}
+
 long long runKruskalAndPrint() {
     // prepare KEdges from CSV rows (one undirected edge per row: node i <-> ConnectedTo[i])
     kedgeCount = 0;
@@ -267,71 +452,1349 @@ long long runKruskalAndPrint() {
             KEdges[kedgeCount].v = v;
             KEdges[kedgeCount].w = w;
             kedgeCount++;
-            if (kedgeCount >= MAX_EDGES) break;
         }
     }
-    sort(KEdges, KEdges + kedgeCount, cmpKEdge);
     uf_make(N);
-    int used = 0;
-    long long total = 0;
-    for (int i = 0; i < kedgeCount && used < N-1; ++i) {
-        int u = KEdges[i].u, v = KEdges[i].v, w = KEdges[i].w;
-        if (uf_find(u) != uf_find(v)) {
-            uf_union(u,v);
-            used++;
-            total += w;
+    mstUsed = 0;
+    mstTotal = 0;
+    if (kedgeCount >= PARALLEL_MST_MIN_EDGES) {
+        store.reserve(kTmp, kedgeCount);
+        store.reserve(kCls, kedgeCount);
+        if (store.commit()) {
+            mstThreads = max(1, (int) thread::hardware_concurrency());
+            filterKruskal(0, kedgeCount);
+            return mstTotal;
         }
+        // no room for the partition buffers: plain Kruskal below
     }
-    return total;
+    sort(KEdges, KEdges + kedgeCount, cmpKEdge);
+    kruskalScan(0, kedgeCount);
+    return mstTotal;
 }
 
 // ----------------------------- Dijkstra -----------------------------
+// distArr and the heap use grid's internal ids; parent[] is filled with
+// row ids for the nodes the search reached (parent[src] = -1).
+//
+// Nothing is cleared per query: distArr[v] only counts when distSeen[v]
+// holds the current query's stamp, and the heap is emptied on the way
+// out, so a query costs O(visited) rather than O(N).
+unsigned queryStamp = 0;
+int querySettled = 0;   // nodes settled by the last query
+
+// bumps the stamp, clearing distSeen on the rare wrap-around
+unsigned nextStamp(unsigned *seen, unsigned &stamp) {
+    if (++stamp == 0) {
+        memset(seen, 0, sizeof(unsigned) * N);
+        stamp = 1;
+    }
+    return stamp;
+}
+
 long long runDijkstra(int src,int dest, int parent[]) {
-    // initialize
-    static int distArr[MAX_NODES];
-    for (int i = 0; i < N; ++i) { distArr[i] = INF; parent[i] = -1; }
-    heapInit(N);
+    if (src < 0 || src >= N || dest < 0 || dest >= N) return -1;
+    unsigned stamp = nextStamp(distSeen, queryStamp);
+    parent[src] = -1;
+    querySettled = 0;
+    src = grid.order(src);
+    dest = grid.order(dest);
     distArr[src] = 0;
+    distSeen[src] = stamp;
     heapPushOrUpdate(src, 0);
     while (!heapEmpty()) {
         pair<int,int> p = heapPop();
         int u = p.first;
         int d = p.second;
         if (d != distArr[u]) continue;
+        querySettled++;
         if (u == dest) break;
-        for (int ei = head[u]; ei != -1; ei = adj_next[ei]) {
-            int v = adj_to[ei], w = adj_w[ei];
-            if (distArr[u] + w < distArr[v]) {
+        for (int a = grid.begin(u); a < grid.end(u); ++a) {
+            int v = grid.target(a), w = grid.weight(a);
+            if (distSeen[v] != stamp || distArr[u] + w < distArr[v]) {
                 distArr[v] = distArr[u] + w;
-                parent[v] = u;
+                distSeen[v] = stamp;
+                parent[grid.node(v)] = grid.node(u);
                 heapPushOrUpdate(v, distArr[v]);
             }
         }
     }
-    return (distArr[dest] >= INF ? -1 : distArr[dest]);
+    // leave heap_pos all -1 for the next query
+    for (int i = 0; i < heap_size; ++i) heap_pos[heap_node[i]] = -1;
+    heap_size = 0;
+    return (distSeen[dest] != stamp ? -1 : distArr[dest]);
 }
 
 // ----------------------------- Build adjacency -----------------------------
 void buildAdjacency() {
-    for (int i = 0; i < N; ++i) head[i] = -1;
-    adj_ptr = 0;
-    for (int i = 0; i < N; ++i) {
-        int u = i, v = ConnectedTo[i];
-        if (v < 0 || v >= N) continue;
-        int w = LineResInt[i];
-        // add u->v and v->u (undirected)
-        addEdgeAdj(u, v, w);
-        addEdgeAdj(v, u, w);
-        E += 2;
+    bool ok = grid.build(store, N, [](samarthaka::CsrGraph::Sink &arc) {
+        for (int i = 0; i < N; ++i) {
+            int u = i, v = ConnectedTo[i];
+            if (v < 0 || v >= N) continue;
+            int w = LineResInt[i];
+            // add u->v and v->u (undirected)
+            arc(u, v, w);
+            arc(v, u, w);
+        }
+    });
+    if (ok && N >= REORDER_MIN_NODES) ok = grid.reorderRcm(store);
+    if (!ok) {
+        cerr << "Out of memory for the grid adjacency\n";
+        exit(1);
     }
+    E = grid.arcs();
+}
+
+// ----------------------------- Point-to-point queries -----------------------------
+// Outage triage asks for many src -> dest routes on one grid:
+//   Q_DIJKSTRA  runDijkstra above
+//   Q_BIDI      bidirectional Dijkstra; the grid is undirected, so the
+//               backward search walks the same arcs
+//   Q_ALT       A* on landmark lower bounds (ALT): for every landmark L,
+//               |d(L,dest) - d(L,v)| <= d(v,dest), distances to LANDMARKS
+//               far-apart nodes being computed once by prepareQueries()
+//   Q_CH        upward searches in a contraction hierarchy (below)
+// Per-node state is stamped like distSeen, so a query never clears O(N)
+// arrays.  Node ids below are grid's internal ids.
+enum QueryMethod { Q_DIJKSTRA, Q_BIDI, Q_ALT, Q_CH };
+
+const int LANDMARKS = 8;
+
+// one direction of a search: stamped labels plus a lazy min-heap
+// (stale entries are skipped when popped; one push per relaxation, so
+// E + 1 slots are enough)
+struct Frontier {
+    int *dist, *par;
+    unsigned *seen;
+    int *hnode;
+    long long *hkey;
+    int hsize;
+
+    long long top() const { return hsize ? hkey[0] : LLONG_MAX; }
+
+    void push(int v, long long key) {
+        int i = hsize++;
+        while (i > 0 && hkey[(i - 1) / 2] > key) {
+            hnode[i] = hnode[(i - 1) / 2];
+            hkey[i] = hkey[(i - 1) / 2];
+            i = (i - 1) / 2;
+        }
+        hnode[i] = v;
+        hkey[i] = key;
+    }
+
+    int pop(long long &key) {
+        int v = hnode[0];
+        key = hkey[0];
+        int n = --hsize, i = 0;
+        int lastNode = hnode[n];
+        long long last = hkey[n];
+        while (true) {
+            int c = 2 * i + 1;
+            if (c >= n) break;
+            if (c + 1 < n && hkey[c + 1] < hkey[c]) c++;
+            if (hkey[c] >= last) break;
+            hnode[i] = hnode[c];
+            hkey[i] = hkey[c];
+            i = c;
+        }
+        hnode[i] = lastNode;
+        hkey[i] = last;
+        return v;
+    }
+
+    void start(int v, unsigned stamp, long long key) {
+        hsize = 0;
+        dist[v] = 0;
+        par[v] = -1;
+        seen[v] = stamp;
+        push(v, key);
+    }
+};
+
+Frontier fwd, bwd;
+unsigned p2pStamp = 0;
+int *altH;              // ALT bound of a node reached by fwd (stamped by fwd.seen)
+int *lmDist;            // lmDist[v * LANDMARKS + l] = d(landmark l, v), INF if unreachable
+int landmark[LANDMARKS];
+int queryMeet = -1;     // last query: node where the two halves of the path join
+
+unsigned nextP2PStamp() {
+    if (++p2pStamp == 0) {
+        memset(fwd.seen, 0, sizeof(unsigned) * N);
+        memset(bwd.seen, 0, sizeof(unsigned) * N);
+        p2pStamp = 1;
+    }
+    return p2pStamp;
+}
+
+// full Dijkstra from src over fwd (landmark preprocessing)
+void sweepFrom(int src) {
+    unsigned stamp = nextP2PStamp();
+    fwd.start(src, stamp, 0);
+    while (fwd.hsize) {
+        long long key;
+        int u = fwd.pop(key);
+        if (key != fwd.dist[u]) continue;
+        for (int a = grid.begin(u); a < grid.end(u); ++a) {
+            int v = grid.target(a), nd = fwd.dist[u] + grid.weight(a);
+            if (fwd.seen[v] == stamp && nd >= fwd.dist[v]) continue;
+            fwd.dist[v] = nd;
+            fwd.seen[v] = stamp;
+            fwd.push(v, nd);
+        }
+    }
+}
+
+// lower bound on d(v, t); INF when no landmark sees both (other component)
+int altBound(int v, int t) {
+    const int *a = lmDist + (size_t) v * LANDMARKS, *b = lmDist + (size_t) t * LANDMARKS;
+    int h = 0;
+    for (int l = 0; l < LANDMARKS; ++l) {
+        if (a[l] >= INF || b[l] >= INF) {
+            if (a[l] != b[l]) return INF;
+            continue;
+        }
+        h = max(h, abs(a[l] - b[l]));
+    }
+    return h;
+}
+
+// Allocates the query state; with alt, also picks the landmarks (each the
+// node farthest from those chosen so far, other components first) and
+// stores their distances.  False if out of memory.
+bool prepareQueries(bool alt) {
+    store.reserve(fwd.dist, N);
+    store.reserve(fwd.par, N);
+    store.reserve(fwd.seen, N);
+    store.reserve(fwd.hnode, (size_t) E + 1);
+    store.reserve(fwd.hkey, (size_t) E + 1);
+    store.reserve(bwd.dist, N);
+    store.reserve(bwd.par, N);
+    store.reserve(bwd.seen, N);
+    store.reserve(bwd.hnode, (size_t) E + 1);
+    store.reserve(bwd.hkey, (size_t) E + 1);
+    store.reserve(altH, N);
+    if (alt) store.reserve(lmDist, (size_t) N * LANDMARKS);
+    if (!store.commit()) return false;
+    if (!alt || N == 0) return true;
+
+    // bwd.dist: distance to the nearest landmark so far (scratch)
+    int *nearest = bwd.dist;
+    sweepFrom(0);
+    for (int v = 0; v < N; ++v) nearest[v] = fwd.seen[v] == p2pStamp ? fwd.dist[v] : INF;
+    for (int l = 0; l < LANDMARKS; ++l) {
+        int far = 0;
+        for (int v = 1; v < N; ++v)
+            if (nearest[v] > nearest[far]) far = v;
+        landmark[l] = far;
+        sweepFrom(far);
+        for (int v = 0; v < N; ++v) {
+            int d = fwd.seen[v] == p2pStamp ? fwd.dist[v] : INF;
+            lmDist[(size_t) v * LANDMARKS + l] = d;
+            nearest[v] = min(nearest[v], d);
+        }
+    }
+    return true;
+}
+
+long long bidiQuery(int s, int t) {
+    unsigned stamp = nextP2PStamp();
+    querySettled = 0;
+    queryMeet = s;
+    fwd.start(s, stamp, 0);
+    bwd.start(t, stamp, 0);
+    if (s == t) return 0;
+    long long best = INF;
+    while (fwd.hsize && bwd.hsize) {
+        // no unsettled pair of labels can beat best any more
+        if (fwd.top() + bwd.top() >= best) break;
+        // grow the side with the smaller radius
+        bool forward = fwd.top() <= bwd.top();
+        Frontier &f = forward ? fwd : bwd, &o = forward ? bwd : fwd;
+        long long key;
+        int u = f.pop(key);
+        if (key != f.dist[u]) continue;
+        querySettled++;
+        for (int a = grid.begin(u); a < grid.end(u); ++a) {
+            int v = grid.target(a), nd = f.dist[u] + grid.weight(a);
+            if (f.seen[v] == stamp && nd >= f.dist[v]) continue;
+            f.dist[v] = nd;
+            f.par[v] = u;
+            f.seen[v] = stamp;
+            f.push(v, nd);
+            if (o.seen[v] == stamp && (long long) nd + o.dist[v] < best) {
+                best = (long long) nd + o.dist[v];
+                queryMeet = v;
+            }
+        }
+    }
+    return best >= INF ? -1 : best;
+}
+
+long long altQuery(int s, int t) {
+    unsigned stamp = nextP2PStamp();
+    querySettled = 0;
+    queryMeet = t;
+    int h0 = altBound(s, t);
+    if (h0 >= INF) return -1;
+    fwd.start(s, stamp, h0);
+    altH[s] = h0;
+    while (fwd.hsize) {
+        long long key;
+        int u = fwd.pop(key);
+        if (key != (long long) fwd.dist[u] + altH[u]) continue;
+        querySettled++;
+        if (u == t) return fwd.dist[u];
+        for (int a = grid.begin(u); a < grid.end(u); ++a) {
+            int v = grid.target(a), nd = fwd.dist[u] + grid.weight(a);
+            if (fwd.seen[v] != stamp) altH[v] = altBound(v, t);
+            else if (nd >= fwd.dist[v]) continue;
+            fwd.dist[v] = nd;
+            fwd.par[v] = u;
+            fwd.seen[v] = stamp;
+            fwd.push(v, (long long) nd + altH[v]);
+        }
+    }
+    return -1;
+}
+
+// ----------------------------- Contraction hierarchy -----------------------------
+// Optional preprocessing for Q_CH.  Nodes are contracted one at a time,
+// cheapest first (edge difference + contracted neighbours).  Contracting v
+// turns each of v's remaining edges into an "up" arc of v, and adds a
+// shortcut u - w for every pair of remaining neighbours that has no
+// witness path of at most d(u,v) + d(v,w) avoiding v.  A query is two
+// upward Dijkstras, from src and from dest, that meet at the top.
+//
+// Each arc remembers the two arcs it stands for (both leave the node it
+// bypasses), so unpacking rebuilds the original node sequence.  Arcs are
+// stored by lower endpoint in CSR form and saved to <csv>.ch; the file is
+// reused while the grid (hashed arc by arc) is unchanged.
+const int WITNESS_SETTLE = 64;     // witness searches give up (and add the shortcut) past this
+
+struct ChEntry { int to, w, a, b, next; };   // live adjacency during contraction
+struct ChArc { int from, to, w, a, b; };     // bypassed node -> from / -> to, -1 for an edge
+
+int *chStart;           // N + 1, up arcs of u are [chStart[u], chStart[u + 1])
+ChArc *chArc;
+int chArcs = 0, chArcCapacity = 0;
+int *chStackArc;        // unpacking scratch, N each
+bool *chStackDir;
+int chShortcuts = 0;
+
+// doubles an arena array, keeping the first used elements
+template <class T>
+bool growArray(T *&arr, int &cap, int used) {
+    T *bigger;
+    store.reserve(bigger, 2 * (size_t) cap);
+    if (!store.commit()) return false;
+    memcpy(bigger, arr, sizeof(T) * used);
+    arr = bigger;
+    cap *= 2;
+    return true;
+}
+
+// contraction state
+ChEntry *chAdj;
+int *chHead, chAdjCount, chAdjCap;
+bool *chDone;
+int *chDeleted;                    // contracted neighbours so far
+int *pqNode, *pqPos, pqSize;       // indexed min-heap of (key, node)
+long long *pqKey;
+
+void pqSwap(int i, int j) {
+    swap(pqNode[i], pqNode[j]);
+    swap(pqKey[i], pqKey[j]);
+    pqPos[pqNode[i]] = i;
+    pqPos[pqNode[j]] = j;
+}
+void pqSet(int v, long long key) {
+    int i = pqPos[v];
+    if (i < 0) {
+        i = pqSize++;
+        pqNode[i] = v;
+        pqPos[v] = i;
+    }
+    pqKey[i] = key;
+    while (i > 0 && pqKey[(i - 1) / 2] > pqKey[i]) { pqSwap(i, (i - 1) / 2); i = (i - 1) / 2; }
+    while (true) {
+        int c = 2 * i + 1;
+        if (c >= pqSize) break;
+        if (c + 1 < pqSize && pqKey[c + 1] < pqKey[c]) c++;
+        if (pqKey[c] >= pqKey[i]) break;
+        pqSwap(i, c);
+        i = c;
+    }
+}
+int pqPop() {
+    int v = pqNode[0];
+    pqSwap(0, --pqSize);
+    pqPos[v] = -1;
+    int i = 0;
+    while (true) {
+        int c = 2 * i + 1;
+        if (c >= pqSize) break;
+        if (c + 1 < pqSize && pqKey[c + 1] < pqKey[c]) c++;
+        if (pqKey[c] >= pqKey[i]) break;
+        pqSwap(i, c);
+        i = c;
+    }
+    return v;
+}
+
+// live entry u -> x, or -1
+int chFind(int u, int x) {
+    for (int e = chHead[u]; e != -1; e = chAdj[e].next)
+        if (chAdj[e].to == x) return e;
+    return -1;
+}
+
+// adds or shortens the undirected edge u - x; false if out of memory
+bool chLink(int u, int x, int w, int a, int b) {
+    int e = chFind(u, x);
+    if (e >= 0) {
+        if (chAdj[e].w <= w) return true;
+        int f = chFind(x, u);
+        chAdj[e].w = chAdj[f].w = w;
+        chAdj[e].a = chAdj[f].a = a;
+        chAdj[e].b = chAdj[f].b = b;
+        return true;
+    }
+    if (chAdjCount + 2 > chAdjCap && !growArray(chAdj, chAdjCap, chAdjCount)) return false;
+    chAdj[chAdjCount] = ChEntry{x, w, a, b, chHead[u]};
+    chHead[u] = chAdjCount++;
+    chAdj[chAdjCount] = ChEntry{u, w, a, b, chHead[x]};
+    chHead[x] = chAdjCount++;
+    return true;
+}
+
+// drops entries to contracted nodes from u's list, returns the live degree
+int chPrune(int u) {
+    int deg = 0;
+    for (int *e = &chHead[u]; *e != -1;) {
+        if (chDone[chAdj[*e].to]) *e = chAdj[*e].next;
+        else { deg++; e = &chAdj[*e].next; }
+    }
+    return deg;
+}
+
+// Dijkstra from u avoiding v, up to limit or WITNESS_SETTLE nodes; leaves
+// stamped distances in fwd
+void witnessSearch(int u, int v, int limit, unsigned stamp) {
+    fwd.start(u, stamp, 0);
+    int settled = 0;
+    while (fwd.hsize && settled < WITNESS_SETTLE) {
+        long long key;
+        int x = fwd.pop(key);
+        if (key != fwd.dist[x]) continue;
+        if (key > limit) break;
+        settled++;
+        for (int e = chHead[x]; e != -1; e = chAdj[e].next) {
+            int y = chAdj[e].to, nd = fwd.dist[x] + chAdj[e].w;
+            if (y == v || chDone[y] || nd > limit) continue;
+            if (fwd.seen[y] == stamp && nd >= fwd.dist[y]) continue;
+            if (fwd.hsize > E) return;          // heap full: stop, shortcuts stay
+            fwd.dist[y] = nd;
+            fwd.seen[y] = stamp;
+            fwd.push(y, nd);
+        }
+    }
+}
+
+// Contracts v (or with dryRun only counts the shortcuts it would add).
+// Returns the shortcut count, -1 if out of memory.
+int chContract(int v, bool dryRun) {
+    chPrune(v);
+    int added = 0, maxW = 0;
+    for (int e = chHead[v]; e != -1; e = chAdj[e].next) maxW = max(maxW, chAdj[e].w);
+
+    int upFirst = chArcs;
+    if (!dryRun) {
+        // v's remaining edges become its up arcs
+        for (int e = chHead[v]; e != -1; e = chAdj[e].next) {
+            if (chArcs == INT_MAX / 2) return -1;
+            if (chArcs + 1 > chArcCapacity && !growArray(chArc, chArcCapacity, chArcs)) return -1;
+            int a = chAdj[e].a, b = chAdj[e].b;
+            if (a >= 0 && chArc[a].to != v) swap(a, b);     // a must lead to from (= v)
+            chArc[chArcs++] = ChArc{v, chAdj[e].to, chAdj[e].w, a, b};
+        }
+    }
+
+    int k = 0;
+    for (int e = chHead[v]; e != -1; e = chAdj[e].next, k++) {
+        int u = chAdj[e].to, du = chAdj[e].w;
+        unsigned stamp = nextP2PStamp();
+        witnessSearch(u, v, du + maxW, stamp);
+        int k2 = 0;
+        for (int f = chHead[v]; f != -1; f = chAdj[f].next, k2++) {
+            int x = chAdj[f].to;
+            if (k2 <= k) continue;              // each pair once
+            int via = du + chAdj[f].w;
+            if (fwd.seen[x] == stamp && fwd.dist[x] <= via) continue;
+            int have = chFind(u, x);
+            if (have >= 0 && chAdj[have].w <= via) continue;
+            added++;
+            if (!dryRun && !chLink(u, x, via, upFirst + k, upFirst + k2)) return -1;
+        }
+    }
+    return added;
+}
+long long chPriority(int v) {
+    int deg = chPrune(v);
+    int added = chContract(v, true);
+    return 2LL * (added - deg) + chDeleted[v];
+}
+
+// 64-bit hash of grid's arcs, identifying the graph a saved hierarchy belongs to
+uint64_t gridHash() {
+    uint64_t h = samarthaka::fnv1a(&N, sizeof N);
+    for (int u = 0; u < N; ++u)
+        for (int a = grid.begin(u); a < grid.end(u); ++a) {
+            int d[3] = {u, grid.target(a), grid.weight(a)};
+            h = samarthaka::fnv1a(d, sizeof d, h);
+        }
+    return h;
+}
+
+struct ChHeader {
+    char magic[8];              // "SKCH\0\0\0\0"
+    uint32_t version;
+    int32_t nodes;
+    int64_t arcs;
+    uint64_t graph;             // gridHash()
+    uint64_t checksum;          // FNV-1a of the arrays after the header
+};
+const uint32_t CH_VERSION = 1;
+
+bool loadCH(const char *path) {
+    samarthaka::MappedFile f;
+    ChHeader h;
+    if (!f.open(path) || f.size() < sizeof h) return false;
+    memcpy(&h, f.data(), sizeof h);
+    size_t body = sizeof(int) * ((size_t) N + 1) + sizeof(ChArc) * (size_t) h.arcs;
+    if (memcmp(h.magic, "SKCH\0\0\0\0", 8) != 0 || h.version != CH_VERSION || h.nodes != N ||
+        h.arcs < 0 || h.arcs > INT_MAX || f.size() != sizeof h + body || h.graph != gridHash() ||
+        h.checksum != samarthaka::fnv1a(f.data() + sizeof h, body))
+        return false;
+    chArcs = (int) h.arcs;
+    store.reserve(chStart, (size_t) N + 1);
+    store.reserve(chArc, (size_t) chArcs);
+    if (!store.commit()) return false;
+    memcpy(chStart, f.data() + sizeof h, sizeof(int) * ((size_t) N + 1));
+    memcpy(chArc, f.data() + sizeof h + sizeof(int) * ((size_t) N + 1), sizeof(ChArc) * chArcs);
+    chShortcuts = 0;
+    for (int a = 0; a < chArcs; ++a) chShortcuts += chArc[a].a >= 0;
+    return true;
+}
+
+// best effort, like the CSV snapshots: written to <path>.tmp, then renamed
+bool saveCH(const char *path) {
+    ChHeader h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, "SKCH\0\0\0\0", 8);
+    h.version = CH_VERSION;
+    h.nodes = N;
+    h.arcs = chArcs;
+    h.graph = gridHash();
+    h.checksum = samarthaka::fnv1a(chArc, sizeof(ChArc) * chArcs,
+                                   samarthaka::fnv1a(chStart, sizeof(int) * ((size_t) N + 1)));
+    char tmp[4200];
+    snprintf(tmp, sizeof tmp, "%s.tmp", path);
+    FILE *out = fopen(tmp, "wb");
+    if (!out) return false;
+    bool ok = fwrite(&h, sizeof h, 1, out) == 1 &&
+              fwrite(chStart, sizeof(int), (size_t) N + 1, out) == (size_t) N + 1 &&
+              fwrite(chArc, sizeof(ChArc), chArcs, out) == (size_t) chArcs;
+    ok = fclose(out) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) { remove(tmp); return false; }
+    return true;
+}
+
+// Contracts every node; the up arcs end up in chStart / chArc.
+bool buildCH() {
+    chAdjCap = max(2 * E, 16);
+    chArcCapacity = max(E, 16);
+    store.reserve(chAdj, chAdjCap);
+    store.reserve(chHead, N);
+    store.reserve(chDone, N);
+    store.reserve(chDeleted, N);
+    store.reserve(pqNode, N);
+    store.reserve(pqPos, N);
+    store.reserve(pqKey, N);
+    store.reserve(chArc, chArcCapacity);
+    store.reserve(chStart, (size_t) N + 1);
+    if (!store.commit()) return false;
+
+    chAdjCount = chArcs = pqSize = 0;
+    for (int u = 0; u < N; ++u) { chHead[u] = -1; pqPos[u] = -1; }
+    for (int u = 0; u < N; ++u)
+        for (int a = grid.begin(u); a < grid.end(u); ++a)
+            if (u < grid.target(a) && !chLink(u, grid.target(a), grid.weight(a), -1, -1)) return false;
+    for (int u = 0; u < N; ++u) pqSet(u, chPriority(u));
+
+    while (pqSize) {
+        int v = pqNode[0];
+        // lazy update: contract v only if it is still the cheapest
+        pqSet(v, chPriority(v));
+        if (pqNode[0] != v) continue;
+        pqPop();
+        if (chContract(v, false) < 0) return false;
+        chDone[v] = true;
+        for (int e = chHead[v]; e != -1; e = chAdj[e].next) {
+            int u = chAdj[e].to;
+            chDeleted[u]++;
+            pqSet(u, chPriority(u));
+        }
+    }
+
+    // arcs were written in contraction order: renumber them by lower
+    // endpoint for CSR, remapping the child ids
+    int *newId, *cursor = pqPos;
+    ChArc *sorted;
+    store.reserve(newId, (size_t) chArcs);
+    store.reserve(sorted, (size_t) chArcs);
+    if (!store.commit()) return false;
+    for (int u = 0; u <= N; ++u) chStart[u] = 0;
+    for (int a = 0; a < chArcs; ++a) chStart[chArc[a].from + 1]++;
+    for (int u = 0; u < N; ++u) chStart[u + 1] += chStart[u];
+    for (int u = 0; u < N; ++u) cursor[u] = chStart[u];
+    for (int a = 0; a < chArcs; ++a) newId[a] = cursor[chArc[a].from]++;
+    for (int a = 0; a < chArcs; ++a) {
+        ChArc c = chArc[a];
+        if (c.a >= 0) { c.a = newId[c.a]; c.b = newId[c.b]; }
+        sorted[newId[a]] = c;
+    }
+    chArc = sorted;
+    chShortcuts = 0;
+    for (int a = 0; a < chArcs; ++a) chShortcuts += chArc[a].a >= 0;
+    return true;
+}
+
+// two upward searches; fwd.par / bwd.par hold the arc that reached a node
+long long chQuery(int s, int t) {
+    unsigned stamp = nextP2PStamp();
+    querySettled = 0;
+    fwd.start(s, stamp, 0);
+    bwd.start(t, stamp, 0);
+    long long best = s == t ? 0 : INF;
+    queryMeet = s;
+    while (true) {
+        bool fwdOn = fwd.top() < best, bwdOn = bwd.top() < best;
+        if (!fwdOn && !bwdOn) break;
+        bool forward = fwdOn && (!bwdOn || fwd.top() <= bwd.top());
+        Frontier &f = forward ? fwd : bwd, &o = forward ? bwd : fwd;
+        long long key;
+        int u = f.pop(key);
+        if (key != f.dist[u]) continue;
+        querySettled++;
+        if (o.seen[u] == stamp && key + o.dist[u] < best) {
+            best = key + o.dist[u];
+            queryMeet = u;
+        }
+        for (int a = chStart[u]; a < chStart[u + 1]; ++a) {
+            int v = chArc[a].to, nd = f.dist[u] + chArc[a].w;
+            if (f.seen[v] == stamp && nd >= f.dist[v]) continue;
+            f.dist[v] = nd;
+            f.par[v] = a;
+            f.seen[v] = stamp;
+            f.push(v, nd);
+        }
+    }
+    return best >= INF ? -1 : best;
+}
+
+// Appends the nodes of arc a, walked from one end to the other, excluding
+// the start (row ids).
+int chUnpack(int a, bool fromTail, int *path, int len) {
+    // explicit stack of (arc, direction), fromTail meaning from -> to; every
+    // pending entry covers at least one original edge, so N slots suffice
+    int *stackArc = chStackArc, sp = 0;
+    bool *stackDir = chStackDir;
+    stackArc[sp] = a;
+    stackDir[sp++] = fromTail;
+    while (sp) {
+        int c = stackArc[--sp];
+        bool dir = stackDir[sp];
+        const ChArc &x = chArc[c];
+        if (x.a < 0) {
+            path[len++] = grid.node(dir ? x.to : x.from);
+            continue;
+        }
+        // x.a runs mid -> from, x.b runs mid -> to; push the second half first
+        if (dir) {
+            stackArc[sp] = x.b; stackDir[sp++] = true;     // mid -> to
+            stackArc[sp] = x.a; stackDir[sp++] = false;    // from -> mid
+        } else {
+            stackArc[sp] = x.a; stackDir[sp++] = true;     // mid -> from
+            stackArc[sp] = x.b; stackDir[sp++] = false;    // to -> mid
+        }
+    }
+    return len;
+}
+
+// Loads <csv>.ch, or builds the hierarchy and saves it.  False if out of memory.
+bool prepareCH(const char *csvPath) {
+    char path[4096];
+    snprintf(path, sizeof path, "%s.ch", csvPath);
+    auto t0 = chrono::steady_clock::now();
+    bool loaded = loadCH(path);
+    if (!loaded && !buildCH()) return false;
+    store.reserve(chStackArc, N);
+    store.reserve(chStackDir, N);
+    if (chArcs > E) {
+        // upward searches push once per arc relaxed
+        store.reserve(fwd.hnode, (size_t) chArcs + 1);
+        store.reserve(fwd.hkey, (size_t) chArcs + 1);
+        store.reserve(bwd.hnode, (size_t) chArcs + 1);
+        store.reserve(bwd.hkey, (size_t) chArcs + 1);
+    }
+    if (!store.commit()) return false;
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    cout << "Contraction hierarchy: " << chArcs << " up arcs (" << chShortcuts << " shortcuts), ";
+    if (loaded) cout << "loaded from " << path << " in " << (long long) ms << " ms\n";
+    else cout << "built in " << (long long) ms << " ms" << (saveCH(path) ? ", saved to " : ", could not save ") << path << "\n";
+    return true;
+}
+
+// Shortest src -> dest distance (row ids), -1 if unreachable.  The path
+// is written to path[0..len) as row ids.
+long long pointQuery(int src, int dest, QueryMethod m, int *path, int &len) {
+    len = 0;
+    if (src < 0 || src >= N || dest < 0 || dest >= N) return -1;
+    if (m == Q_DIJKSTRA) {
+        long long d = runDijkstra(src, dest, dijParent);
+        if (d < 0) return -1;
+        for (int cur = dest; cur != -1; cur = dijParent[cur]) path[len++] = cur;
+        reverse(path, path + len);
+        return d;
+    }
+    int s = grid.order(src), t = grid.order(dest);
+    if (m == Q_CH) {
+        long long d = chQuery(s, t);
+        if (d < 0) return -1;
+        // meet back down to src, reversed, then meet down to dest
+        path[len++] = grid.node(queryMeet);
+        for (int cur = queryMeet; cur != s; cur = chArc[fwd.par[cur]].from)
+            len = chUnpack(fwd.par[cur], false, path, len);
+        reverse(path, path + len);
+        for (int cur = queryMeet; cur != t; cur = chArc[bwd.par[cur]].from)
+            len = chUnpack(bwd.par[cur], false, path, len);
+        return d;
+    }
+    long long d = m == Q_BIDI ? bidiQuery(s, t) : altQuery(s, t);
+    if (d < 0) return -1;
+    // forward half back from the meeting node, then the backward half
+    for (int cur = queryMeet; cur != -1; cur = fwd.par[cur]) path[len++] = grid.node(cur);
+    reverse(path, path + len);
+    if (m == Q_BIDI)
+        for (int cur = bwd.par[queryMeet]; cur != -1; cur = bwd.par[cur]) path[len++] = grid.node(cur);
+    return d;
+}
+
+// Answers "src dest" lines (row ids; blank and # lines skipped) from file
+// or stdin ("-"), one line of output per query (two with paths).
+int runQueries(const char *file, QueryMethod m, bool paths) {
+    static const char *names[] = {"dijkstra", "bidi", "alt", "ch"};
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cerr << "Unable to open " << file << "\n";
+        return 1;
+    }
+    auto t0 = chrono::steady_clock::now();
+    if (!prepareQueries(m == Q_ALT) || (m == Q_CH && !prepareCH("samarthaka_grid.csv"))) {
+        cerr << "Out of memory for the query engine\n";
+        return 1;
+    }
+    double prepMs = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+
+    cout << "=== POINT-TO-POINT QUERIES (" << names[m] << ") ===\n";
+    char line[256];
+    long long queries = 0, settled = 0;
+    double queryMs = 0;
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+        int src, dest;
+        if (sscanf(p, "%d %d", &src, &dest) != 2) {
+            cout << "  bad query: " << p;
+            continue;
+        }
+        int len;
+        auto q0 = chrono::steady_clock::now();
+        long long d = pointQuery(src, dest, m, pathBuf, len);
+        queryMs += chrono::duration<double, milli>(chrono::steady_clock::now() - q0).count();
+        queries++;
+        settled += querySettled;
+        if (d < 0) cout << "  " << src << " -> " << dest << ": unreachable\n";
+        else cout << "  " << src << " -> " << dest << ": dist=" << d << " hops=" << len - 1 << "\n";
+        if (d >= 0 && paths) {
+            cout << "    Path: ";
+            for (int i = 0; i < len; i++) cout << pathBuf[i] << (i + 1 < len ? " -> " : "\n");
+        }
+    }
+    if (in != stdin) fclose(in);
+    cout << "Queries: " << queries;
+    if (queries) cout << "   avg settled: " << settled / queries;
+    cout << "   prep: " << (long long) prepMs << " ms   per query: "
+         << (queries ? (long long)(queryMs * 1000 / queries) : 0) << " us\n";
+    return 0;
+}
+
+// ----------------------------- Outage engine -----------------------------
+// "Which nodes lose supply if edges {...} fail": edges are KEdges ids,
+// supply means a path to node 0.
+//
+// outagePrepare() walks the grid once (DFS from node 0, then from every
+// node not reached).  Each non-tree edge gets a random 64-bit label and
+// each tree edge the XOR of the labels of the non-tree edges spanning it:
+//   - a tree edge labelled 0 is a bridge, and failing it cuts off the
+//     subtree below it;
+//   - two non-bridges cut the grid exactly when their labels match (up to
+//     a 2^-64 collision), cutting off what lies between them.
+// So every N-1 and N-2 contingency is answered in O(1) from subtree sizes.
+//
+// Arbitrary scenarios go through outageSolve(): offline dynamic
+// connectivity.  An edge is present in the runs of scenarios between its
+// failures; each run is hung on the O(log Q) nodes of a segment tree over
+// the scenarios that cover it, and a walk down the tree unions a node's
+// edges on the way in and rolls them back on the way out (union by size,
+// no path compression).  Edges that never fail are unioned once, so a
+// batch costs O((E + failures * log Q) * log N) instead of O(E) per scenario.
+samarthaka::CsrGraph kgrid;     // KEdges both ways, weight = edge id
+int *ocTin, *ocSub;             // DFS preorder number, subtree size
+int *ocChild;                   // per edge: lower end of a tree edge, -1 otherwise
+uint64_t *ocLabel;              // per edge: 0 for a bridge
+bool *ocLive;                   // per node: supplied with nothing failed
+int ocLiveCount = 0;
+
+// rollback union-find for outageSolve
+int *ocPar, *ocSize, *ocHist, ocHistLen;
+int *ocStart, *ocHung;          // segment tree node -> hung edge ids (CSR)
+int ocQ;
+
+uint64_t splitmix64(uint64_t x) {
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// Bridges, labels and subtree sizes of the current KEdges.  False if out of memory.
+bool outagePrepare() {
+    bool ok = kgrid.build(store, N, [](samarthaka::CsrGraph::Sink &arc) {
+        for (int i = 0; i < kedgeCount; i++) {
+            arc(KEdges[i].u, KEdges[i].v, i);
+            if (KEdges[i].u != KEdges[i].v) arc(KEdges[i].v, KEdges[i].u, i);
+        }
+    });
+    int *it, *up, *stack;
+    uint64_t *acc;
+    store.reserve(ocTin, N);
+    store.reserve(ocSub, N);
+    store.reserve(ocLive, N);
+    store.reserve(ocChild, kedgeCount);
+    store.reserve(ocLabel, kedgeCount);
+    store.reserve(ocPar, N);
+    store.reserve(ocSize, N);
+    store.reserve(ocHist, N);
+    store.reserve(it, N);
+    store.reserve(up, N);
+    store.reserve(stack, N);
+    store.reserve(acc, N);
+    if (!ok || !store.commit()) return false;
+
+    for (int v = 0; v < N; v++) ocTin[v] = -1;
+    for (int e = 0; e < kedgeCount; e++) ocChild[e] = -1;
+    int timer = 0;
+    for (int r = 0; r < N; r++) {
+        if (ocTin[r] >= 0) continue;
+        int sp = 0;
+        stack[sp++] = r;
+        ocTin[r] = timer++;
+        ocSub[r] = 1;
+        it[r] = kgrid.begin(r);
+        up[r] = -1;
+        while (sp) {
+            int u = stack[sp - 1];
+            if (it[u] < kgrid.end(u)) {
+                int a = it[u]++, v = kgrid.target(a), e = kgrid.weight(a);
+                if (e == up[u]) continue;
+                if (ocTin[v] < 0) {
+                    ocTin[v] = timer++;
+                    ocSub[v] = 1;
+                    it[v] = kgrid.begin(v);
+                    up[v] = e;
+                    ocChild[e] = v;
+                    stack[sp++] = v;
+                } else if (ocTin[v] <= ocTin[u]) {
+                    // back edge (or self-loop), seen from its lower end
+                    ocLabel[e] = splitmix64(e) | 1;
+                    acc[u] ^= ocLabel[e];
+                    acc[v] ^= ocLabel[e];
+                }
+                continue;
+            }
+            sp--;
+            if (up[u] >= 0) {
+                int p = stack[sp - 1];
+                ocLabel[up[u]] = acc[u];
+                acc[p] ^= acc[u];
+                ocSub[p] += ocSub[u];
+            }
+        }
+        if (r == 0) {
+            // node 0's tree was numbered first
+            ocLiveCount = timer;
+            for (int v = 0; v < N; v++) ocLive[v] = ocTin[v] >= 0;
+        }
+    }
+    return true;
+}
+
+bool isBridge(int e) { return ocChild[e] >= 0 && ocLabel[e] == 0; }
+
+// nodes that lose supply when e fails
+int lostN1(int e) {
+    return isBridge(e) && ocLive[ocChild[e]] ? ocSub[ocChild[e]] : 0;
+}
+
+// nodes that lose supply when e and f fail
+int lostN2(int e, int f) {
+    if (e == f) return lostN1(e);
+    if (!ocLive[KEdges[e].u] || !ocLive[KEdges[f].u]) return max(lostN1(e), lostN1(f));
+    if (isBridge(e) || isBridge(f)) {
+        if (!isBridge(e) || !isBridge(f)) return max(lostN1(e), lostN1(f));
+        // two subtrees: nested or disjoint
+        int a = ocChild[e], b = ocChild[f];
+        if (ocTin[a] > ocTin[b]) swap(a, b);
+        return ocTin[b] < ocTin[a] + ocSub[a] ? ocSub[a] : ocSub[a] + ocSub[b];
+    }
+    if (ocLabel[e] != ocLabel[f]) return 0;
+    // the only back edge over a tree edge, or two tree edges on one path
+    if (ocChild[e] < 0 || ocChild[f] < 0) return ocChild[e] < 0 ? (ocChild[f] < 0 ? 0 : ocSub[ocChild[f]]) : ocSub[ocChild[e]];
+    return abs(ocSub[ocChild[e]] - ocSub[ocChild[f]]);
+}
+
+int ocFind(int x) {
+    while (ocPar[x] != x) x = ocPar[x];
+    return x;
+}
+void ocUnite(int a, int b) {
+    a = ocFind(a); b = ocFind(b);
+    if (a == b) return;
+    if (ocSize[a] < ocSize[b]) swap(a, b);
+    ocPar[b] = a;
+    ocSize[a] += ocSize[b];
+    ocHist[ocHistLen++] = b;
+}
+void ocRollback(int len) {
+    while (ocHistLen > len) {
+        int b = ocHist[--ocHistLen];
+        ocSize[ocPar[b]] -= ocSize[b];
+        ocPar[b] = b;
+    }
+}
+
+// segment tree node covering scenarios [lo, lo + width)
+template <class F>
+void ocWalk(int node, int lo, int width, F &visit) {
+    if (lo >= ocQ) return;
+    int mark = ocHistLen;
+    for (int k = ocStart[node]; k < ocStart[node + 1]; k++)
+        ocUnite(KEdges[ocHung[k]].u, KEdges[ocHung[k]].v);
+    if (width == 1) {
+        visit(lo);
+    } else {
+        ocWalk(2 * node, lo, width / 2, visit);
+        ocWalk(2 * node + 1, lo + width / 2, width / 2, visit);
+    }
+    ocRollback(mark);
+}
+
+// Scenario q fails the edges fail[start[q] .. start[q + 1]) (ids outside
+// KEdges are ignored).  visit(q) is called for each scenario with ocFind /
+// ocSize describing the grid minus its failures.  Needs outagePrepare();
+// false if out of memory.
+template <class F>
+bool outageSolve(const int *fail, const int *start, int Q, F visit) {
+    int P = 1;
+    while (P < Q) P *= 2;
+    long long *occ;                 // edge << 32 | scenario, sorted
+    store.reserve(occ, (size_t) start[Q] + 1);
+    store.reserve(ocStart, 2 * (size_t) P + 1);
+    if (!store.commit()) return false;
+    int m = 0;
+    for (int q = 0; q < Q; q++)
+        for (int j = start[q]; j < start[q + 1]; j++)
+            if (fail[j] >= 0 && fail[j] < kedgeCount) occ[m++] = (long long) fail[j] << 32 | q;
+    sort(occ, occ + m);
+    m = (int) (unique(occ, occ + m) - occ);
+
+    // each failing edge is present in the runs between its failures
+    auto runs = [&](auto hang) {
+        for (int i = 0; i < m;) {
+            int e = (int) (occ[i] >> 32), from = 0;
+            for (; i < m && (int) (occ[i] >> 32) == e; i++) {
+                int q = (int) (occ[i] & 0xffffffff);
+                if (from < q) hang(e, from, q);
+                from = q + 1;
+            }
+            if (from < Q) hang(e, from, Q);
+        }
+    };
+    auto cover = [P](int l, int r, auto put) {
+        for (l += P, r += P; l < r; l >>= 1, r >>= 1) {
+            if (l & 1) put(l++);
+            if (r & 1) put(--r);
+        }
+    };
+    for (int i = 0; i <= 2 * P; i++) ocStart[i] = 0;
+    runs([&](int, int l, int r) { cover(l, r, [&](int node) { ocStart[node + 1]++; }); });
+    for (int i = 0; i < 2 * P; i++) ocStart[i + 1] += ocStart[i];
+    int *fill;
+    store.reserve(ocHung, (size_t) ocStart[2 * P] + 1);
+    store.reserve(fill, 2 * (size_t) P);
+    if (!store.commit()) return false;
+    memcpy(fill, ocStart, sizeof(int) * 2 * P);
+    runs([&](int e, int l, int r) { cover(l, r, [&](int node) { ocHung[fill[node]++] = e; }); });
+
+    // edges that never fail stay unioned for the whole walk
+    for (int v = 0; v < N; v++) { ocPar[v] = v; ocSize[v] = 1; }
+    for (int e = 0, i = 0; e < kedgeCount; e++) {
+        while (i < m && (int) (occ[i] >> 32) < e) i++;
+        if (i == m || (int) (occ[i] >> 32) != e) ocUnite(KEdges[e].u, KEdges[e].v);
+    }
+    ocHistLen = 0;
+    ocQ = Q;
+    ocWalk(1, 0, P, visit);
+    return true;
+}
+
+// nodes supplied (connected to node 0) in the scenario being visited
+int ocSupplied() { return ocSize[ocFind(0)]; }
+
+// N-1 and N-2 sweep over every edge and every pair of edges.
+void contingencyReport() {
+    int bridges = 0, treeEdges = 0, liveBridges = 0, worst1 = -1;
+    for (int e = 0; e < kedgeCount; e++) {
+        if (ocChild[e] >= 0) treeEdges++;
+        if (!isBridge(e)) continue;
+        bridges++;
+        if (!ocLive[ocChild[e]]) continue;
+        liveBridges++;
+        if (worst1 < 0 || lostN1(e) > lostN1(worst1)) worst1 = e;
+    }
+    cout << "=== CONTINGENCY SWEEP ===\n";
+    cout << "Edges: " << kedgeCount << "   bridges: " << bridges
+         << "   2-edge-connected components: " << N - (treeEdges - bridges)
+         << "   supplied nodes: " << ocLiveCount << "\n";
+    cout << "N-1: " << liveBridges << " of " << kedgeCount << " single failures cut supply";
+    if (worst1 >= 0)
+        cout << "; worst: edge #" << worst1 << " (" << KEdges[worst1].u << " - " << KEdges[worst1].v
+             << ") cuts " << lostN1(worst1) << " nodes";
+    cout << "\n";
+
+    // N-2: every pair holding a supplied bridge, plus the pairs of supplied
+    // non-bridges with equal labels (grouped by sorting)
+    int *ids;
+    store.reserve(ids, kedgeCount);
+    if (!store.commit()) {
+        cerr << "Out of memory for the contingency sweep\n";
+        return;
+    }
+    int n = 0;
+    for (int e = 0; e < kedgeCount; e++)
+        if (!isBridge(e) && ocLive[KEdges[e].u]) ids[n++] = e;
+    sort(ids, ids + n, [](int a, int b) { return ocLabel[a] < ocLabel[b]; });
+    long long E2 = kedgeCount, B = liveBridges, cutPairs = 0;
+    int worst2 = 0, wa = -1, wb = -1;
+    for (int i = 0, j; i < n; i = j) {
+        // a group's tree edges lie on one root path: the top one (largest
+        // subtree) cuts the most together with a back edge, else the bottom one
+        int top = -1, bottom = -1, back = -1;
+        for (j = i; j < n && ocLabel[ids[j]] == ocLabel[ids[i]]; j++) {
+            int e = ids[j];
+            if (ocChild[e] < 0) { back = e; continue; }
+            if (top < 0 || ocSub[ocChild[e]] > ocSub[ocChild[top]]) top = e;
+            if (bottom < 0 || ocSub[ocChild[e]] < ocSub[ocChild[bottom]]) bottom = e;
+        }
+        cutPairs += (long long) (j - i) * (j - i - 1) / 2;
+        int other = back >= 0 ? back : bottom;
+        if (top < 0 || other == top) continue;
+        int lost = lostN2(top, other);
+        if (lost > worst2) { worst2 = lost; wa = top; wb = other; }
+    }
+    cout << "N-2: " << B * (E2 - B) + B * (B - 1) / 2 + cutPairs << " of " << E2 * (E2 - 1) / 2
+         << " failure pairs cut supply, " << cutPairs << " of them without a bridge";
+    if (wa >= 0)
+        cout << "; worst such pair: edges #" << min(wa, wb) << ", #" << max(wa, wb) << " cut " << worst2 << " nodes";
+    cout << "\n";
+}
+
+// Answers failure scenarios from file or stdin ("-"), one per line as
+// KEdges ids (blank and # lines skipped), all solved in one outageSolve().
+int runOutages(const char *file) {
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cerr << "Unable to open " << file << "\n";
+        return 1;
+    }
+    int failCap = 64, startCap = 64, nf = 0, Q = 0;
+    int *fail, *start;
+    store.reserve(fail, failCap);
+    store.reserve(start, startCap);
+    if (!store.commit()) {
+        cerr << "Out of memory for the outage scenarios\n";
+        return 1;
+    }
+    cout << "=== OUTAGE SCENARIOS ===\n";
+    static char line[1 << 16];
+    bool oom = false;
+    while (!oom && fgets(line, sizeof(line), in)) {
+        char *p = line, *endp;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+        int first = nf;
+        bool bad = false;
+        for (long id; (id = strtol(p, &endp, 10)), endp != p; p = endp) {
+            if (id < 0 || id >= kedgeCount) bad = true;
+            if (nf == failCap && !growArray(fail, failCap, nf)) { oom = true; break; }
+            fail[nf++] = (int) id;
+        }
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+        if (bad || *p) {
+            cout << "  bad scenario: " << line;
+            nf = first;
+            continue;
+        }
+        if (Q + 2 > startCap && !growArray(start, startCap, Q + 1)) { oom = true; break; }
+        start[++Q] = nf;
+    }
+    if (in != stdin) fclose(in);
+
+    auto t0 = chrono::steady_clock::now();
+    int *lost;
+    store.reserve(lost, (size_t) Q + 1);
+    if (oom || !store.commit() || !outageSolve(fail, start, Q, [lost](int q) { lost[q] = ocLiveCount - ocSupplied(); })) {
+        cerr << "Out of memory for the outage scenarios\n";
+        return 1;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    for (int q = 0; q < Q; q++)
+        cout << "  scenario " << q + 1 << " (" << start[q + 1] - start[q] << " failed): "
+             << lost[q] << " nodes lose supply\n";
+    cout << "Scenarios: " << Q << "   failures: " << nf << "   solved in " << (long long) ms << " ms\n";
+    return 0;
+}
+
+// Applies meter operations from file or stdin ("-") to the meter tree,
+// rows l..r inclusive (blank and # lines skipped):
+//   add l r x    every meter in the range += x (tariff adjustment)
+//   set l r x    every meter in the range = x
+//   sum l r      prints sum / min / max of the range
+// Runs of sum lines are answered together through queryBatch().
+int runMeterOps(const char *file) {
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cerr << "Unable to open " << file << "\n";
+        return 1;
+    }
+    const int BATCH = 4096;
+    static int ql[BATCH], qr[BATCH];
+    static samarthaka::RangeTree<long long>::Agg qa[BATCH];
+    int pending = 0;
+    long long updates = 0, queries = 0;
+    double ms = 0;
+    auto answer = [&]() {
+        auto t0 = chrono::steady_clock::now();
+        meters.queryBatch(ql, qr, pending, qa);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        for (int j = 0; j < pending; j++)
+            cout << "  sum " << ql[j] << " " << qr[j] - 1 << ": " << qa[j].sum
+                 << "   min: " << qa[j].min << "   max: " << qa[j].max << "\n";
+        queries += pending;
+        pending = 0;
+    };
+
+    cout << "=== METER OPERATIONS ===\n";
+    char line[256], op[8];
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+        int l, r;
+        long long x = 0;
+        int got = sscanf(p, "%7s %d %d %lld", op, &l, &r, &x);
+        bool isSum = got >= 3 && strcmp(op, "sum") == 0;
+        bool isAdd = got == 4 && strcmp(op, "add") == 0, isSet = got == 4 && strcmp(op, "set") == 0;
+        if ((!isSum && !isAdd && !isSet) || l < 0 || r < l || r >= N) {
+            if (pending) answer();
+            cout << "  bad operation: " << p;
+            continue;
+        }
+        if (isSum) {
+            ql[pending] = l;
+            qr[pending] = r + 1;
+            if (++pending == BATCH) answer();
+            continue;
+        }
+        if (pending) answer();
+        auto t0 = chrono::steady_clock::now();
+        if (isAdd) meters.add(l, r + 1, x);
+        else meters.assign(l, r + 1, x);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        updates++;
+    }
+    if (pending) answer();
+    if (in != stdin) fclose(in);
+    cout << "Updates: " << updates << "   queries: " << queries << "   tree time: " << (long long) ms << " ms\n";
+    return 0;
+}
+
+// Loads interval readings (header, then grid row, epoch seconds, Wh per
+// line) into the usage store.
+int loadReadings(const char *file) {
+    int *row;
+    long long *when, *wh;
+    samarthaka::CsvBinding csv;
+    csv.bind(0, row);
+    csv.bind(1, when);
+    csv.bind(2, wh);
+    int rows = csv.load(file, store, samarthaka::CSV_PARALLEL | samarthaka::CSV_SNAPSHOT);
+    if (rows < 0) {
+        cerr << csv.error() << "\n";
+        return 1;
+    }
+    auto t0 = chrono::steady_clock::now();
+    if (!usage.build(store, row, when, wh, (size_t) rows, N, USAGE_BUCKET, USAGE_SLOT)) {
+        cerr << "Out of memory for the readings store\n";
+        return 1;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+    cout << "=== METER READINGS ===\n";
+    cout << "Readings: " << usage.readings() << " (" << rows - (long long) usage.readings()
+         << " skipped)   meters: " << usage.series() << "   days with readings: " << usage.buckets() << "\n";
+    cout << "Packed: " << usage.bytes() << " bytes ("
+         << (usage.readings() ? (double) usage.bytes() / usage.readings() : 0.0)
+         << " per reading)   built in " << (long long) ms << " ms\n";
+    return 0;
+}
+
+// Answers usage queries from file or stdin ("-"), one "l r t0 t1" per line:
+// Wh used by rows l..r inclusive over epoch seconds [t0, t1).
+int runUsage(const char *file) {
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cerr << "Unable to open " << file << "\n";
+        return 1;
+    }
+    cout << "=== USAGE QUERIES ===\n";
+    char line[256];
+    long long queries = 0;
+    double ms = 0;
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+        int l, r;
+        long long t0, t1;
+        if (sscanf(p, "%d %d %lld %lld", &l, &r, &t0, &t1) != 4 || l < 0 || r < l || r >= N || t1 < t0) {
+            cout << "  bad query: " << p;
+            continue;
+        }
+        auto start = chrono::steady_clock::now();
+        long long wh = usage.sum(l, r + 1, t0, t1);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        queries++;
+        cout << "  rows " << l << ".." << r << " [" << t0 << ", " << t1 << "): " << wh << " Wh\n";
+    }
+    if (in != stdin) fclose(in);
+    cout << "Queries: " << queries << "   avg " << (queries ? ms * 1000 / queries : 0.0) << " us/query\n";
+    return 0;
+}
+
+// Re-prioritises generation sources from file or stdin ("-"):
+//   set row kw   the source's current output; 0 or less takes it off dispatch
+//   top          prints the source dispatch would pick now
+int runDispatch(const char *file) {
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cerr << "Unable to open " << file << "\n";
+        return 1;
+    }
+    cout << "=== DISPATCH ===\n";
+    char line[256], op[8];
+    long long updates = 0, tops = 0;
+    double ms = 0;
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line;
+        while (*p == ' ' || *p == '\t') p++;
+        if (*p == '#' || *p == '\n' || *p == '\r' || *p == 0) continue;
+        int node = -1, kw = 0;
+        int got = sscanf(p, "%7s %d %d", op, &node, &kw);
+        if (got >= 1 && strcmp(op, "top") == 0) {
+            int best = srcTop();
+            tops++;
+            if (best < 0) cout << "  top: none\n";
+            else cout << "  top: " << best << " (" << NodeType[best] << ", " << src_key[0] << " kW)\n";
+            continue;
+        }
+        if (got != 3 || strcmp(op, "set") != 0 || node < 0 || node >= N || !isSource(node)) {
+            cout << "  bad operation: " << p;
+            continue;
+        }
+        auto t0 = chrono::steady_clock::now();
+        if (kw > 0) srcSet(node, kw);
+        else srcRemove(node);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        updates++;
+    }
+    if (in != stdin) fclose(in);
+    cout << "Updates: " << updates << "   tops: " << tops << "   sources on dispatch: " << src_size
+         << "   queue time: " << (long long) ms << " ms\n";
+    return 0;
 }
 
 // ----------------------------- main -----------------------------
 
-int main() {
+int main(int argc, char **argv) {
     ios::sync_with_stdio(false);
     cin.tie(nullptr);
 
+    const char *queryFile = NULL, *outageFile = NULL, *meterFile = NULL;
+    const char *readingsFile = NULL, *usageFile = NULL, *dispatchFile = NULL;
+    bool contingency = false;
+    QueryMethod method = Q_ALT;
+    bool paths = false;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--queries") == 0 && a + 1 < argc) queryFile = argv[++a];
+        else if (strcmp(argv[a], "--method") == 0 && a + 1 < argc) {
+            const char *m = argv[++a];
+            if (strcmp(m, "dijkstra") == 0) method = Q_DIJKSTRA;
+            else if (strcmp(m, "bidi") == 0) method = Q_BIDI;
+            else if (strcmp(m, "alt") == 0) method = Q_ALT;
+            else if (strcmp(m, "ch") == 0) method = Q_CH;
+            else { cerr << "Unknown method " << m << " (dijkstra|bidi|alt|ch)\n"; return 1; }
+        } else if (strcmp(argv[a], "--paths") == 0) paths = true;
+        else if (strcmp(argv[a], "--outages") == 0 && a + 1 < argc) outageFile = argv[++a];
+        else if (strcmp(argv[a], "--contingency") == 0) contingency = true;
+        else if (strcmp(argv[a], "--meter-ops") == 0 && a + 1 < argc) meterFile = argv[++a];
+        else if (strcmp(argv[a], "--readings") == 0 && a + 1 < argc) readingsFile = argv[++a];
+        else if (strcmp(argv[a], "--usage") == 0 && a + 1 < argc) usageFile = argv[++a];
+        else if (strcmp(argv[a], "--dispatch") == 0 && a + 1 < argc) dispatchFile = argv[++a];
+        else {
+            cerr << "Usage: " << argv[0] << " [--queries file|- [--method dijkstra|bidi|alt|ch] [--paths]]"
+                 << " [--outages file|-] [--contingency] [--meter-ops file|-]"
+                 << " [--readings file [--usage file|-]] [--dispatch file|-]\n";
+            return 1;
+        }
+    }
+    if (usageFile && !readingsFile) {
+        cerr << "--usage needs --readings\n";
+        return 1;
+    }
+
     cout << "Loading CSV 'samarthaka_grid.csv' ...\n";
     loadCSV("samarthaka_grid.csv");
     cout << "Loaded rows: " << N << "\n\n";
@@ -339,29 +1802,16 @@ int main() {
     // ------------------ AUTOMATIC HEAP ------------------
     cout << "=== POWER SOURCE SELECTION (HEAP) ===\n";
 
-    srcHeapSize = 0;
-    for (int i = 0; i < N && i < 512; ++i) {
-        if (strcmp(NodeType[i], "SolarPlant") == 0 ||
-            strcmp(NodeType[i], "WindFarm") == 0 ||
-            strcmp(NodeType[i], "HydroPlant") == 0) {
+    for (int i = 0; i < N; ++i)
+        if (isSource(i)) srcSet(i, sourceScore(i));
 
-            Source s;
-            s.id = i;
-            strcpy(s.type, NodeType[i]);
-            s.score = 50 + (rand() % 51);  // 50–100
-            srcPush(s);
-        }
-    }
-
-    Source best = srcTop();
+    int best = srcTop();
     cout << "Best Power Source Automatically Selected:\n";
-    cout << "  ID = " << best.id << "\n";
-    cout << "  Type = " << best.type << "\n";
-    cout << "  Score = " << best.score << "\n\n";
+    cout << "  ID = " << best << "\n";
+    cout << "  Type = " << (best < 0 ? "None" : NodeType[best]) << "\n";
+    cout << "  Score = " << (best < 0 ? -1 : src_key[0]) << "\n\n";
 
     // ------------------ BUILD ADJACENCY ------------------
-    for (int i = 0; i < N; i++) head[i] = -1;
-    E = 0;
     buildAdjacency();
     cout << "Adjacency built. Directed edges = " << E << "\n\n";
 
@@ -380,20 +1830,23 @@ int main() {
 
     // ------------------ SEGMENT TREE ------------------
     cout << "=== SEGMENT TREE (AUTO DEMO) ===\n";
-    segBuild(1, 0, N - 1);
+    if (!meters.build(store, MeterMonth, N)) {
+        cerr << "Out of memory for the meter tree\n";
+        return 1;
+    }
 
-    long long fullSum = segQuery(1, 0, N - 1, 0, N - 1);
+    long long fullSum = meters.query(0, N).sum;
     cout << "Total Monthly Consumption of City = " << fullSum << "\n";
 
     cout << "Query: Sum of first 100 houses = "
-         << segQuery(1, 0, N - 1, 0, 99) << "\n";
+         << meters.query(0, 100).sum << "\n";
 
     cout << "Updating meter[10] += 500...\n";
     MeterMonth[10] += 500;
-    segUpdate(1, 0, N - 1, 10, MeterMonth[10]);
+    meters.set(10, MeterMonth[10]);
 
     cout << "New sum of first 100 houses = "
-         << segQuery(1, 0, N - 1, 0, 99) << "\n\n";
+         << meters.query(0, 100).sum << "\n\n";
 
     // ------------------ DIJKSTRA AUTO ------------------
     cout << "=== DIJKSTRA SHORTEST PATH (AUTO) ===\n";
@@ -401,13 +1854,13 @@ int main() {
     int src = 0;
     int dest = ConnectedTo[0];  // natural city route
 
-    int parent[MAX_NODES];
+    int *parent = dijParent;
     long long dist = runDijkstra(src, dest, parent);
 
     if (dist >= 0) {
         cout << "Shortest Path from " << src << " to " << dest << " = " << dist << "\n";
         cout << "Path: ";
-        int path[MAX_NODES], len = 0, cur = dest;
+        int *path = pathBuf, len = 0, cur = dest;
         while (cur != -1) {
             path[len++] = cur;
             cur = parent[cur];
@@ -427,46 +1880,37 @@ int main() {
 cout << "\n=== OUTAGE DETECTION (AUTO) ===\n";
 cout << "Simulating failures on edges #2, #5, #10\n\n";
 
-// Declare ONCE
-static bool disabled[MAX_EDGES];
-
-// Reset all to false
-for (int i = 0; i < kedgeCount; i++)
-    disabled[i] = false;
+// Mark failures (skipped when the grid has fewer edges)
+const int failed[] = {2, 5, 10};
+int failList[3], failStart[2] = {0, 0};
+for (int f : failed)
+    if (f < kedgeCount) failList[failStart[1]++] = f;
 
-// Mark failures
-disabled[2] = true;
-disabled[5] = true;
-disabled[10] = true;
+// Recompute connectivity (one scenario through the outage engine)
+if (!outagePrepare() || !outageSolve(failList, failStart, 1, [](int) {
 
-// Recompute connectivity
-uf_make(N);
-for (int i = 0; i < kedgeCount; i++) {
-    if (!disabled[i])
-        uf_union(KEdges[i].u, KEdges[i].v);
-}
-
-// Determine disconnected nodes
-int root = uf_find(0);
-int groupCount = 0;
-
-cout << "Disconnected Nodes (showing first 15 only):\n";
+    // Determine disconnected nodes
+    int root = ocFind(0);
+    int groupCount = N - ocSize[root];
 
-for (int i = 0; i < N; i++) {
-    if (uf_find(i) != root) {
+    cout << "Disconnected Nodes (showing first 15 only):\n";
 
-        if (groupCount < 15)
+    for (int i = 0, shown = 0; i < N && shown < min(groupCount, 15); i++) {
+        if (ocFind(i) != root) {
             cout << "  • Node " << i << " disconnected\n";
-
-        groupCount++;
+            shown++;
+        }
     }
-}
 
-if (groupCount == 0) {
-    cout << "  No nodes were disconnected. Grid remains stable.\n";
-} else {
-    cout << "\nTotal disconnected nodes = " << groupCount << "\n";
-    cout << "(Only first 15 shown to maintain clean output.)\n";
+    if (groupCount == 0) {
+        cout << "  No nodes were disconnected. Grid remains stable.\n";
+    } else {
+        cout << "\nTotal disconnected nodes = " << groupCount << "\n";
+        cout << "(Only first 15 shown to maintain clean output.)\n";
+    }
+})) {
+    cerr << "Out of memory for the outage engine\n";
+    return 1;
 }
 
 cout << "\n=== END OF OUTAGE REPORT ===\n\n";
@@ -474,5 +1918,30 @@ cout << "\n=== END OF OUTAGE REPORT ===\n\n";
 
 
     cout << "=== PROGRAM COMPLETE (AUTO MODE) ===\n";
+    if (contingency) {
+        cout << "\n";
+        contingencyReport();
+    }
+    if (outageFile) {
+        cout << "\n";
+        if (runOutages(outageFile)) return 1;
+    }
+    if (meterFile) {
+        cout << "\n";
+        if (runMeterOps(meterFile)) return 1;
+    }
+    if (readingsFile) {
+        cout << "\n";
+        if (loadReadings(readingsFile)) return 1;
+        if (usageFile && runUsage(usageFile)) return 1;
+    }
+    if (dispatchFile) {
+        cout << "\n";
+        if (runDispatch(dispatchFile)) return 1;
+    }
+    if (queryFile) {
+        cout << "\n";
+        return runQueries(queryFile, method, paths);
+    }
     return 0;
 }
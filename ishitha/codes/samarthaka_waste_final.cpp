@@ -1,15 +1,25 @@
 // samarthaka_waste_final.cpp
-// Compile: g++ samarthaka_waste_final.cpp -O2 -o samarthaka_waste_final
-// Run: ./samarthaka_waste_final
+// Compile: g++ samarthaka_waste_final.cpp -O2 -pthread -o samarthaka_waste_final
+// Run: ./samarthaka_waste_final [depot route id ...]
+//          [--cvrp truck_kg]
+//          [--stream file|- [--every N] [--seconds S] [--follow]]
 // Reads: samarthaka_waste_corrected.csv
 
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cmath>
 #include <iomanip>
 #include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+#include "../../common/csv_mmap.h"
+#include "../../common/top_k.h"
+#include "../../common/id_bitmap.h"
+#include "../../common/code_column.h"
 
 using namespace std;
 
@@ -17,20 +27,24 @@ using namespace std;
    CONSTANTS & CSV STORAGE
    ============================================================ */
 
-const int MAX_BINS = 11000;
-const int MAX_ROUTES = 1200;
-const int MAX_EDGES = 200000;
 const int INF = 1000000000;
 const double EARTH_R = 6371000.0;
 
-/* CSV columns */
-static int BinID[MAX_BINS];
-static char Zone[MAX_BINS][16];
-static double Lat[MAX_BINS], Lon[MAX_BINS];
-static char Waste[MAX_BINS][24];
-static int RouteID[MAX_BINS];
-static int NearbyPop[MAX_BINS];
-static char Sensor[MAX_BINS][8];
+/* CSV columns: sized from the file, storage owned by the arena */
+static samarthaka::ColumnArena store;
+
+static int *BinID;
+static char (*Zone)[16];
+static double *Lat, *Lon;
+static char (*Waste)[24];
+static int *RouteID;
+static int *NearbyPop;
+static char (*Sensor)[8];
+
+/* Zone / Waste / Sensor interned at load time: one code byte per row,
+   the text lives once in the dictionary */
+static uint8_t *ZoneCode, *WasteCode, *SensorCode;
+static samarthaka::StringDict zoneDict, wasteDict, sensorDict;
 
 static int BIN_COUNT = 0;
 
@@ -38,16 +52,23 @@ static int BIN_COUNT = 0;
    ROUTE GRAPH STORAGE
    ============================================================ */
 
-static double Rlat[MAX_ROUTES], Rlon[MAX_ROUTES];
-static int Rcount[MAX_ROUTES];
+/* sized by buildRouteGraph: one slot per route, K edges per route */
+static double *Rlat, *Rlon;
+static int *Rcount;
 
 struct Edge { int u, v, w; };
-static Edge edges[MAX_EDGES];
+static Edge *edges;
 static int edgeCount = 0;
+static int edgeCap = 0;                /* Nnodes * K: edges[] capacity */
+static int graphK = 0;
 static int Nnodes = 0;
+static double *knnKth;                 /* K-th neighbour distance; 1e18 if fewer */
 
-static int distBF[MAX_ROUTES];
-static int parentBF[MAX_ROUTES];
+static int *distBF;
+static int *parentBF;
+static int *pathBuf;
+
+bool prepareShortestPaths();
 
 /* ============================================================
    DEG → RAD FIX (No M_PI)
@@ -76,53 +97,441 @@ double haversine_m(double a1, double b1, double a2, double b2) {
    ============================================================ */
 
 bool loadCSV(const char* fname) {
-    ifstream fin(fname);
-    if (!fin.is_open()) {
-        cout << "ERROR: Cannot open CSV file.\n";
+    samarthaka::CsvBinding csv;
+    csv.bind(0, BinID);
+    csv.bind(1, Zone);
+    csv.bind(2, Lat);
+    csv.bind(3, Lon);
+    csv.bind(4, Waste);
+    csv.bind(5, RouteID);
+    csv.bind(6, NearbyPop);
+    csv.bind(7, Sensor);
+
+    // typed columns are cached in samarthaka_waste_corrected.csv.snap after the first parse
+    int rows = csv.load(fname, store, samarthaka::CSV_SNAPSHOT);
+    if (rows < 0) {
+        cout << "ERROR: " << csv.error() << "\n";
+        return false;
+    }
+
+    BIN_COUNT = rows;
+
+    store.reserve(ZoneCode, rows);
+    store.reserve(WasteCode, rows);
+    store.reserve(SensorCode, rows);
+    if (!store.commit()) {
+        cout << "ERROR: out of memory for " << rows << " rows\n";
         return false;
     }
+    // more than 255 distinct values leaves NO_CODE rows; readers fall
+    // back to the text column for those
+    zoneDict.encode(Zone, rows, ZoneCode);
+    wasteDict.encode(Waste, rows, WasteCode);
+    sensorDict.encode(Sensor, rows, SensorCode);
+    return true;
+}
+
+/* ============================================================
+   BATCH HAVERSINE
+   ============================================================ */
 
-    string line;
-    getline(fin, line); // skip header
+/*
+ * Distances from one point to a contiguous run of points.  Points carry
+ * their latitude/longitude in radians and cos(lat), precomputed once, so
+ * the loop body is branch-free polynomial arithmetic the compiler can
+ * vectorise:
+ *   sin  - Taylor series to x^15 on |x| <= pi/2     (|error| < 7e-12)
+ *   asin - Taylor series to x^31 on [0, 1/2]        (|error| < 1e-12),
+ *          larger arguments via asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2))
+ * Measured against haversine_m over 12M random pairs the result is off by
+ * less than 1 mm up to 19 000 km, and by less than 100 m closer to the
+ * antipode, where haversine_m itself is ill-conditioned; havBatchErr()
+ * returns that bound for an estimate.
+ *
+ * HAV_EQUIRECT skips the trig entirely: planar distance with longitude
+ * scaled by the mean cos(lat) of the two points.  It is within 0.05% of
+ * haversine_m below 100 km away from the poles (|lat| < 80), which makes
+ * it a cheap pre-filter when an exact check follows.
+ */
+
+enum HavMode { HAV_POLY, HAV_EQUIRECT };
+
+/* bound on |haversineBatch(HAV_POLY) - haversine_m| for an estimate est */
+inline double havBatchErr(double est) {
+    return est < 19000000.0 - 100.0 ? 1e-3 : 100.0;
+}
 
-    BIN_COUNT = 0;
+struct GeoPoints {
+    const double *lat, *lon, *cosLat;   // radians, radians, cos(lat)
+};
 
-    while (getline(fin, line) && BIN_COUNT < MAX_BINS) {
-        stringstream ss(line);
-        string tok;
+static inline double sinPoly(double x) {
+    double x2 = x * x;
+    return x * (1.0 + x2 * (-1.6666666666666666e-01 + x2 * (8.3333333333333332e-03 +
+           x2 * (-1.9841269841269841e-04 + x2 * (2.7557319223985893e-06 +
+           x2 * (-2.5052108385441720e-08 + x2 * (1.6059043836821613e-10 +
+           x2 * -7.6471637318198164e-13)))))));
+}
 
-        getline(ss, tok, ','); BinID[BIN_COUNT] = atoi(tok.c_str());
-        getline(ss, tok, ','); strncpy(Zone[BIN_COUNT], tok.c_str(), 15);
-        getline(ss, tok, ','); Lat[BIN_COUNT] = atof(tok.c_str());
-        getline(ss, tok, ','); Lon[BIN_COUNT] = atof(tok.c_str());
-        getline(ss, tok, ','); strncpy(Waste[BIN_COUNT], tok.c_str(), 23);
-        getline(ss, tok, ','); RouteID[BIN_COUNT] = atoi(tok.c_str());
-        getline(ss, tok, ','); NearbyPop[BIN_COUNT] = atoi(tok.c_str());
-        getline(ss, tok, ','); strncpy(Sensor[BIN_COUNT], tok.c_str(), 7);
+static inline double asinPoly(double x) {        // 0 <= x <= 1/2
+    double x2 = x * x;
+    double p = 0.0046601434869150962;
+    p = p * x2 + 0.0051533096823199046;
+    p = p * x2 + 0.0057400376708419236;
+    p = p * x2 + 0.0064472103118896487;
+    p = p * x2 + 0.0073125258735988454;
+    p = p * x2 + 0.0083903358096168151;
+    p = p * x2 + 0.0097616095291940784;
+    p = p * x2 + 0.011551800896139705;
+    p = p * x2 + 0.013964843750000001;
+    p = p * x2 + 0.017352764423076924;
+    p = p * x2 + 0.022372159090909092;
+    p = p * x2 + 0.030381944444444444;
+    p = p * x2 + 0.044642857142857144;
+    p = p * x2 + 0.074999999999999997;
+    p = p * x2 + 0.16666666666666666;
+    return x + x * x2 * p;
+}
 
-        BIN_COUNT++;
+void haversineBatch(double lat0, double lon0, double cos0, GeoPoints pts, int n,
+                    double *out, HavMode mode = HAV_POLY) {
+    const double PI = 3.141592653589793;
+    const double *__restrict lat = pts.lat;
+    const double *__restrict lon = pts.lon;
+    const double *__restrict cl = pts.cosLat;
+
+    if (mode == HAV_EQUIRECT) {
+        for (int i = 0; i < n; i++) {
+            double dlat = lat[i] - lat0;
+            double dlon = fabs(lon[i] - lon0);
+            dlon = dlon > PI ? 2.0 * PI - dlon : dlon;
+            double x = dlon * 0.5 * (cos0 + cl[i]);
+            out[i] = EARTH_R * sqrt(dlat * dlat + x * x);
+        }
+        return;
     }
 
-    fin.close();
-    return true;
+    for (int i = 0; i < n; i++) {
+        double hlat = 0.5 * (lat[i] - lat0);
+        double hlon = 0.5 * fabs(lon[i] - lon0);
+        hlon = hlon > 0.5 * PI ? PI - hlon : hlon;     // sin^2 is symmetric about pi/2
+
+        double s = sinPoly(hlat), t = sinPoly(hlon);
+        double aa = s * s + cos0 * cl[i] * t * t;
+        aa = aa < 0.0 ? 0.0 : (aa > 1.0 ? 1.0 : aa);
+
+        double x = sqrt(aa);
+        double y = sqrt(0.5 * (1.0 - x));
+        double c = x > 0.5 ? 0.5 * PI - 2.0 * asinPoly(y) : asinPoly(x);
+        out[i] = 2.0 * EARTH_R * c;
+    }
+}
+
+/* ============================================================
+   SPATIAL INDEX — k-d tree over route centroids
+   ============================================================ */
+
+/*
+ * Centroids are stored as unit vectors on the sphere.  The straight-line
+ * (chord) distance between two unit vectors never exceeds the great-circle
+ * distance, so |q[axis] - split| * EARTH_R is a lower bound on haversine_m
+ * for everything on the far side of a split.  Leaves hold up to KD_LEAF
+ * routes stored contiguously in tree order; a query scores a whole leaf
+ * with haversineBatch and only calls haversine_m on routes the batch
+ * estimate cannot rule out.  Neighbours (and their order, ties broken by
+ * lower route id) are therefore exactly those of the all-pairs scan.
+ */
+
+const int KD_LEAF = 16;
+
+static double (*kdPt)[3];    // unit vector per route
+static int *kdPerm;          // routes in tree order; node [lo, hi) splits at mid
+static unsigned char *kdAxis;
+static double *kdSplit;
+static double *kdLat, *kdLon, *kdCos;   // per tree slot, for haversineBatch
+static double *kdMaxKth;     // per inner node (at mid): largest knnKth below it
+static int kdSize = 0;
+
+/* routes moved since the tree was built: tree slot emptied (-1 in kdPerm),
+   route kept in kdExtra and checked exactly by every query */
+const int KD_EXTRA_MAX = 64;
+static int *kdSlot;          // tree slot per route, -1 if not in the tree
+static int kdExtra[KD_EXTRA_MAX];
+static int kdExtraCount = 0;
+
+static void unitVector(double latDeg, double lonDeg, double p[3]) {
+    double la = deg2rad(latDeg), lo = deg2rad(lonDeg);
+    p[0] = cos(la) * cos(lo);
+    p[1] = cos(la) * sin(lo);
+    p[2] = sin(la);
+}
+
+static void kdBuild(int lo, int hi) {
+    if (hi - lo <= KD_LEAF) return;
+
+    double mn[3] = {1e9, 1e9, 1e9}, mx[3] = {-1e9, -1e9, -1e9};
+    for (int i = lo; i < hi; i++)
+        for (int a = 0; a < 3; a++) {
+            double c = kdPt[kdPerm[i]][a];
+            if (c < mn[a]) mn[a] = c;
+            if (c > mx[a]) mx[a] = c;
+        }
+    int axis = 0;
+    for (int a = 1; a < 3; a++)
+        if (mx[a] - mn[a] > mx[axis] - mn[axis]) axis = a;
+
+    // [lo, mid) lies at or below the split on axis, [mid, hi) at or above
+    int mid = (lo + hi) / 2;
+    nth_element(kdPerm + lo, kdPerm + mid, kdPerm + hi,
+                [axis](int a, int b) { return kdPt[a][axis] < kdPt[b][axis]; });
+    kdAxis[mid] = (unsigned char) axis;
+    kdSplit[mid] = kdPt[kdPerm[mid]][axis];
+
+    kdBuild(lo, mid);
+    kdBuild(mid, hi);
+}
+
+/* indexes every route with at least one bin */
+void buildSpatialIndex() {
+    kdSize = 0;
+    kdExtraCount = 0;
+    for (int r = 0; r < Nnodes; r++) {
+        kdSlot[r] = -1;
+        if (Rcount[r] == 0) continue;
+        unitVector(Rlat[r], Rlon[r], kdPt[r]);
+        kdPerm[kdSize++] = r;
+    }
+    kdBuild(0, kdSize);
+
+    for (int i = 0; i < kdSize; i++) {
+        int r = kdPerm[i];
+        kdSlot[r] = i;
+        kdLat[i] = deg2rad(Rlat[r]);
+        kdLon[i] = deg2rad(Rlon[r]);
+        kdCos[i] = cos(kdLat[i]);
+    }
+}
+
+const int KNN_SLACK = 16;    // shortlist entries beyond K
+
+struct KnnQuery {
+    int u, K, cnt;
+    double lat, lon, cosLat;    // u, as in kdLat/kdLon/kdCos
+    double *bestD;
+    int *bestR;
+
+    // shortlist by haversineBatch estimate (kdCollect)
+    int ecnt;
+    double estD[20 + KNN_SLACK];
+    int estR[20 + KNN_SLACK];
+    double dropped;             // smallest estimate that fell off the shortlist
+};
+
+/* keeps the K smallest (distance, route id) pairs, ascending */
+static void knnOffer(KnnQuery &q, double d, int v) {
+    int t;
+    if (q.cnt == q.K) {
+        t = q.K - 1;
+        if (d > q.bestD[t] || (d == q.bestD[t] && v > q.bestR[t])) return;
+    } else {
+        t = q.cnt++;
+    }
+    while (t > 0 && (d < q.bestD[t - 1] || (d == q.bestD[t - 1] && v < q.bestR[t - 1]))) {
+        q.bestD[t] = q.bestD[t - 1];
+        q.bestR[t] = q.bestR[t - 1];
+        t--;
+    }
+    q.bestD[t] = d;
+    q.bestR[t] = v;
+}
+
+/* exact search: every candidate the estimate cannot rule out gets haversine_m */
+static void kdSearch(KnnQuery &q, int lo, int hi) {
+    if (hi - lo <= KD_LEAF) {
+        double est[KD_LEAF];
+        GeoPoints leaf = { kdLat + lo, kdLon + lo, kdCos + lo };
+        haversineBatch(q.lat, q.lon, q.cosLat, leaf, hi - lo, est);
+
+        for (int i = 0; i < hi - lo; i++) {
+            int v = kdPerm[lo + i];
+            if (v == q.u || v < 0) continue;
+            if (q.cnt == q.K && est[i] - havBatchErr(est[i]) > q.bestD[q.K - 1]) continue;
+            knnOffer(q, haversine_m(Rlat[q.u], Rlon[q.u], Rlat[v], Rlon[v]), v);
+        }
+        return;
+    }
+
+    int mid = (lo + hi) / 2;
+    int axis = kdAxis[mid];
+    double gap = kdPt[q.u][axis] - kdSplit[mid];
+    bool left = gap < 0;
+
+    if (left) kdSearch(q, lo, mid); else kdSearch(q, mid, hi);
+
+    // slack covers rounding in both the projection and haversine_m
+    double bound = fabs(gap) * EARTH_R * (1.0 - 1e-9) - 1e-6;
+    if (q.cnt < q.K || bound <= q.bestD[q.K - 1]) {
+        if (left) kdSearch(q, mid, hi); else kdSearch(q, lo, mid);
+    }
+}
+
+/* upper bound on the true K-th distance, from the shortlist */
+static double kthUpper(const KnnQuery &q) {
+    if (q.ecnt < q.K) return 1e18;
+    double e = q.estD[q.K - 1];
+    return e + havBatchErr(e);
+}
+
+static void shortlistOffer(KnnQuery &q, double est, int v) {
+    int cap = q.K + KNN_SLACK;
+    int t;
+    if (q.ecnt == cap) {
+        if (est >= q.estD[cap - 1]) {
+            if (est < q.dropped) q.dropped = est;
+            return;
+        }
+        if (q.estD[cap - 1] < q.dropped) q.dropped = q.estD[cap - 1];
+        t = cap - 1;
+    } else {
+        t = q.ecnt++;
+    }
+    while (t > 0 && est < q.estD[t - 1]) {
+        q.estD[t] = q.estD[t - 1];
+        q.estR[t] = q.estR[t - 1];
+        t--;
+    }
+    q.estD[t] = est;
+    q.estR[t] = v;
+}
+
+/* fast search: shortlist by estimate only, no haversine_m */
+static void kdCollect(KnnQuery &q, int lo, int hi) {
+    if (hi - lo <= KD_LEAF) {
+        double est[KD_LEAF];
+        GeoPoints leaf = { kdLat + lo, kdLon + lo, kdCos + lo };
+        haversineBatch(q.lat, q.lon, q.cosLat, leaf, hi - lo, est);
+
+        for (int i = 0; i < hi - lo; i++) {
+            int v = kdPerm[lo + i];
+            if (v != q.u && v >= 0) shortlistOffer(q, est[i], v);
+        }
+        return;
+    }
+
+    int mid = (lo + hi) / 2;
+    int axis = kdAxis[mid];
+    double gap = kdPt[q.u][axis] - kdSplit[mid];
+    bool left = gap < 0;
+
+    if (left) kdCollect(q, lo, mid); else kdCollect(q, mid, hi);
+
+    double bound = fabs(gap) * EARTH_R * (1.0 - 1e-9) - 1e-6;
+    if (bound <= kthUpper(q)) {
+        if (left) kdCollect(q, mid, hi); else kdCollect(q, lo, mid);
+    }
+}
+
+/*
+ * K nearest routes to u into q.bestD/bestR.  Every route whose estimate
+ * could still beat the K-th distance is on the shortlist unless a route
+ * that close was dropped from it (many near-ties); only then the slower
+ * exact search runs.
+ */
+void nearestRoutes(KnnQuery &q) {
+    q.cnt = q.ecnt = 0;
+    q.dropped = 1e18;
+    kdCollect(q, 0, kdSize);
+
+    double upper = kthUpper(q);
+    if (q.dropped - havBatchErr(q.dropped) <= upper) {
+        kdSearch(q, 0, kdSize);
+    } else {
+        for (int i = 0; i < q.ecnt; i++) {
+            if (q.estD[i] - havBatchErr(q.estD[i]) > upper) break;
+            int v = q.estR[i];
+            knnOffer(q, haversine_m(Rlat[q.u], Rlon[q.u], Rlat[v], Rlon[v]), v);
+        }
+    }
+
+    for (int i = 0; i < kdExtraCount; i++) {
+        int v = kdExtra[i];
+        if (v != q.u) knnOffer(q, haversine_m(Rlat[q.u], Rlon[q.u], Rlat[v], Rlon[v]), v);
+    }
 }
 
 /* ============================================================
    ROUTE GRAPH GENERATION + BELLMAN–FORD
    ============================================================ */
 
-void buildRouteGraph(int K = 10) {
+static bool incremental = false;       /* see enableIncremental */
+
+/* edges from route u to its graphK nearest routes into out; returns the count */
+static int routeEdges(int u, Edge *out) {
+    int K = graphK;
+    double bestD[20];
+    int bestR[20];
+    for (int i = 0; i < K; i++) {
+        bestD[i] = 1e18;
+        bestR[i] = -1;
+    }
+
+    double la = deg2rad(Rlat[u]);
+    KnnQuery q;
+    q.u = u;
+    q.K = K;
+    q.lat = la;
+    q.lon = deg2rad(Rlon[u]);
+    q.cosLat = cos(la);
+    q.bestD = bestD;
+    q.bestR = bestR;
+    if (K > 0) nearestRoutes(q);
+
+    int n = 0;
+    for (int t = 0; t < K; t++) {
+        if (bestR[t] >= 0) {
+            out[n].u = u;
+            out[n].v = bestR[t];
+            out[n].w = (int)(bestD[t] + 0.5);
+            n++;
+        }
+    }
+    knnKth[u] = (K > 0 && bestR[K - 1] >= 0) ? bestD[K - 1] : 1e18;
+    return n;
+}
+
+bool buildRouteGraph(int K = 10) {
     int maxr = 0;
     for (int i = 0; i < BIN_COUNT; i++)
         if (RouteID[i] > maxr) maxr = RouteID[i];
 
+    if (K > 20) K = 20;
+    if (K < 0) K = 0;
+    graphK = K;
     Nnodes = maxr + 1;
-    if (Nnodes > MAX_ROUTES) Nnodes = MAX_ROUTES;
-
-    for (int r = 0; r < Nnodes; r++) {
-        Rlat[r] = 0.0;
-        Rlon[r] = 0.0;
-        Rcount[r] = 0;
+    edgeCap = Nnodes * K;
+    incremental = false;
+
+    store.reserve(Rlat, Nnodes);
+    store.reserve(Rlon, Nnodes);
+    store.reserve(Rcount, Nnodes);
+    store.reserve(edges, edgeCap);
+    store.reserve(knnKth, Nnodes);
+    store.reserve(distBF, Nnodes);
+    store.reserve(parentBF, Nnodes);
+    store.reserve(pathBuf, Nnodes);
+    store.reserve(kdPt, Nnodes);
+    store.reserve(kdPerm, Nnodes);
+    store.reserve(kdAxis, Nnodes);
+    store.reserve(kdSplit, Nnodes);
+    store.reserve(kdLat, Nnodes);
+    store.reserve(kdLon, Nnodes);
+    store.reserve(kdCos, Nnodes);
+    store.reserve(kdSlot, Nnodes);
+    store.reserve(kdMaxKth, Nnodes);
+    if (!store.commit()) {
+        cout << "ERROR: out of memory for " << Nnodes << " route nodes\n";
+        Nnodes = 0;
+        return false;
     }
 
     for (int i = 0; i < BIN_COUNT; i++) {
@@ -141,43 +550,225 @@ void buildRouteGraph(int K = 10) {
         }
     }
 
+    buildSpatialIndex();
     edgeCount = 0;
 
-    for (int u = 0; u < Nnodes; u++) {
-        if (Rcount[u] == 0) continue;
+    for (int u = 0; u < Nnodes; u++)
+        if (Rcount[u] > 0) edgeCount += routeEdges(u, edges + edgeCount);
+    return prepareShortestPaths();
+}
 
-        double bestD[20];
-        int bestR[20];
-        for (int i = 0; i < K; i++) {
-            bestD[i] = 1e18;
-            bestR[i] = -1;
-        }
+/* ---------------- Radix heap (monotone integer keys) ---------------- */
+
+/*
+ * Keys popped never decrease, so an item only needs the bucket of the
+ * highest bit in which it differs from the last popped key.  Items live in
+ * a pool of linked slots (edgeCount + 1, reserved with the workspace) and
+ * are recycled through a free list.
+ */
+struct RadixHeap {
+    unsigned long long *key;
+    int *node, *next;
+    int head[65];
+    int freeSlot, used, size;
+    unsigned long long last;
+    unsigned long long mask;           // bit b-1 set: bucket b non-empty
+
+    void reserve(int slots) {
+        store.reserve(key, slots);
+        store.reserve(node, slots);
+        store.reserve(next, slots);
+    }
 
-        for (int v = 0; v < Nnodes; v++) {
-            if (u == v) continue;
-            if (Rcount[v] == 0) continue;
+    void init() {
+        for (int b = 0; b < 65; b++) head[b] = -1;
+        freeSlot = -1;
+        used = size = 0;
+        last = mask = 0;
+    }
 
-            double d = haversine_m(Rlat[u], Rlon[u], Rlat[v], Rlon[v]);
+    bool empty() const { return size == 0; }
 
-            for (int t = 0; t < K; t++) {
-                if (d < bestD[t]) {
-                    for (int s = K - 1; s > t; s--) {
-                        bestD[s] = bestD[s - 1];
-                        bestR[s] = bestR[s - 1];
-                    }
-                    bestD[t] = d;
-                    bestR[t] = v;
-                    break;
-                }
+    void push(unsigned long long k, int n) {
+        int s = freeSlot;
+        if (s >= 0) freeSlot = next[s];
+        else s = used++;
+        key[s] = k;
+        node[s] = n;
+        link(s, bucket(k));
+        size++;
+    }
+
+    int pop(unsigned long long &k) {
+        if (head[0] < 0) {
+            int b = __builtin_ctzll(mask) + 1;
+
+            unsigned long long mn = ~0ULL;
+            for (int s = head[b]; s >= 0; s = next[s])
+                if (key[s] < mn) mn = key[s];
+            last = mn;
+
+            // every item of bucket b moves to a lower bucket
+            int s = head[b];
+            head[b] = -1;
+            mask &= ~(1ULL << (b - 1));
+            while (s >= 0) {
+                int nx = next[s];
+                link(s, bucket(key[s]));
+                s = nx;
             }
         }
+        size--;
+        int s = head[0];
+        head[0] = next[s];
+        next[s] = freeSlot;
+        freeSlot = s;
+        k = key[s];
+        return node[s];
+    }
+
+private:
+    int bucket(unsigned long long k) const {
+        return k == last ? 0 : 64 - __builtin_clzll(k ^ last);
+    }
+
+    void link(int s, int b) {
+        next[s] = head[b];
+        head[b] = s;
+        if (b) mask |= 1ULL << (b - 1);
+    }
+};
+
+/* ---------------- Shortest paths ---------------- */
+
+struct Arc { int v, w, id; };
+static int *outStart;                  // CSR over edges[], by source route
+static Arc *outArc;                    // edge ids ascending within a route
+static bool negativeEdges = false;
+
+/*
+ * Everything one shortest-path tree needs.  The report uses pathMain
+ * (dist/parent are distBF/parentBF); depotDistances gives each worker
+ * thread its own.
+ */
+struct PathWorkspace {
+    int *dist, *parent;
+    unsigned long long *reachKey;      // see dijkstraRoutes
+    bool *popped;
+    RadixHeap heap;
+
+    void reserve(int heapSlots = edgeCount + 1) {
+        store.reserve(reachKey, Nnodes);
+        store.reserve(popped, Nnodes);
+        heap.reserve(heapSlots);
+    }
+};
 
-        for (int t = 0; t < K; t++) {
-            if (bestR[t] >= 0 && edgeCount < MAX_EDGES) {
-                edges[edgeCount].u = u;
-                edges[edgeCount].v = bestR[t];
-                edges[edgeCount].w = (int)(bestD[t] + 0.5);
-                edgeCount++;
+static PathWorkspace pathMain;
+static int pathSrc = -1;               /* source of the tree in pathMain */
+
+void indexEdges();
+
+/* sizes the edge index and pathMain for up to edgeCap edges */
+bool prepareShortestPaths() {
+    store.reserve(outStart, Nnodes + 1);
+    store.reserve(outArc, edgeCap);
+    // a repair seeds up to one heap entry per route, see repairShortestPaths
+    pathMain.reserve(edgeCap + Nnodes + 1);
+    if (!store.commit()) {
+        cout << "ERROR: out of memory for " << edgeCount << " route edges\n";
+        return false;
+    }
+    pathMain.dist = distBF;
+    pathMain.parent = parentBF;
+    pathSrc = -1;
+    indexEdges();
+    return true;
+}
+
+/* indexes edges[] by source route; call after the edge list changes */
+void indexEdges() {
+    for (int r = 0; r <= Nnodes; r++) outStart[r] = 0;
+    negativeEdges = false;
+    for (int e = 0; e < edgeCount; e++) {
+        outStart[edges[e].u + 1]++;
+        if (edges[e].w < 0) negativeEdges = true;
+    }
+    for (int r = 0; r < Nnodes; r++) outStart[r + 1] += outStart[r];
+    for (int e = 0; e < edgeCount; e++)
+        outArc[outStart[edges[e].u]++] = Arc{ edges[e].v, edges[e].w, e };
+    for (int r = Nnodes; r > 0; r--) outStart[r] = outStart[r - 1];
+    outStart[0] = 0;
+}
+
+/*
+ * Dijkstra for non-negative weights, reproducing bellmanFord's parent
+ * array exactly.  Bellman-Ford keeps the parent of the first relaxation
+ * (in pass, edge-index order) that reaches a route's final distance.  That
+ * moment is tracked as reachKey = pass * (E + 1) + edge + 1: reaching v
+ * over edge e from a route settled at (pass, e') happens in the same pass
+ * if e > e', otherwise in the next one, and among the tight edges
+ * (dist[u] + w == dist[v]) the smallest key wins.
+ *
+ * A tight predecessor over a positive edge is always popped first, so
+ * keys are final when a route is popped.  Only a zero-weight edge between
+ * routes at equal distance can lower the key of an already popped route;
+ * lowerReach then passes the change on.
+ */
+static void lowerReach(PathWorkspace &ws, int u, unsigned long long span) {
+    unsigned long long pass = ws.reachKey[u] / span;
+    long long settledAt = (long long)(ws.reachKey[u] % span) - 1;
+
+    for (int i = outStart[u]; i < outStart[u + 1]; i++) {
+        const Arc &a = outArc[i];
+        if (ws.dist[u] + a.w != ws.dist[a.v]) continue;
+
+        unsigned long long at = (a.id > settledAt ? pass : pass + 1) * span + a.id + 1;
+        if (at < ws.reachKey[a.v]) {
+            ws.reachKey[a.v] = at;
+            ws.parent[a.v] = u;
+            if (ws.popped[a.v]) lowerReach(ws, a.v, span);
+        }
+    }
+}
+
+void dijkstraRoutes(PathWorkspace &ws, int src) {
+    int *dist = ws.dist;
+    for (int i = 0; i < Nnodes; i++) {
+        dist[i] = INF;
+        ws.parent[i] = -1;
+        ws.reachKey[i] = ~0ULL;
+        ws.popped[i] = false;
+    }
+
+    const unsigned long long span = (unsigned long long) edgeCount + 1;
+    dist[src] = 0;
+    ws.reachKey[src] = 0;   // before pass 0; no key can undercut it
+    ws.heap.init();
+    ws.heap.push(0, src);
+    while (!ws.heap.empty()) {
+        unsigned long long k;
+        int u = ws.heap.pop(k);
+        if (k != (unsigned long long) dist[u]) continue;
+        ws.popped[u] = true;
+
+        unsigned long long pass = ws.reachKey[u] / span;
+        long long settledAt = (long long)(ws.reachKey[u] % span) - 1;
+        for (int i = outStart[u]; i < outStart[u + 1]; i++) {
+            const Arc &a = outArc[i];
+            int nd = dist[u] + a.w;
+            if (nd > dist[a.v]) continue;
+
+            unsigned long long at = (a.id > settledAt ? pass : pass + 1) * span + a.id + 1;
+            if (nd < dist[a.v]) {
+                dist[a.v] = nd;
+                ws.reachKey[a.v] = at;
+                ws.parent[a.v] = u;
+                ws.heap.push(nd, a.v);
+            } else if (at < ws.reachKey[a.v]) {
+                ws.reachKey[a.v] = at;
+                ws.parent[a.v] = u;
+                if (ws.popped[a.v]) lowerReach(ws, a.v, span);
             }
         }
     }
@@ -185,13 +776,15 @@ void buildRouteGraph(int K = 10) {
 
 /* ---------------- Bellman-Ford ---------------- */
 
-void bellmanFord(int src) {
+/* general fallback, only needed when some edge weight is negative */
+void bellmanFord(PathWorkspace &ws, int src) {
+    int *dist = ws.dist, *parent = ws.parent;
     for (int i = 0; i < Nnodes; i++) {
-        distBF[i] = INF;
-        parentBF[i] = -1;
+        dist[i] = INF;
+        parent[i] = -1;
     }
 
-    distBF[src] = 0;
+    dist[src] = 0;
 
     for (int it = 0; it < Nnodes - 1; it++) {
         bool changed = false;
@@ -201,9 +794,9 @@ void bellmanFord(int src) {
             int v = edges[e].v;
             int w = edges[e].w;
 
-            if (distBF[u] < INF && distBF[u] + w < distBF[v]) {
-                distBF[v] = distBF[u] + w;
-                parentBF[v] = u;
+            if (dist[u] < INF && dist[u] + w < dist[v]) {
+                dist[v] = dist[u] + w;
+                parent[v] = u;
                 changed = true;
             }
         }
@@ -212,6 +805,62 @@ void bellmanFord(int src) {
     }
 }
 
+void shortestPaths(PathWorkspace &ws, int src) {
+    if (negativeEdges) bellmanFord(ws, src);
+    else dijkstraRoutes(ws, src);
+}
+
+/* route distances from src into distBF/parentBF */
+void shortestPaths(int src) {
+    shortestPaths(pathMain, src);
+    pathSrc = src;
+}
+
+/* ---------------- Multi-depot distance table ---------------- */
+
+/*
+ * Shortest-path trees from every depot, spread over threads (0 = one per
+ * core).  Each thread owns a workspace and writes distances straight into
+ * its depot's row: table[d * Nnodes + r] is the distance from depots[d] to
+ * route r, INF when unreachable.  Invalid depot ids give an all-INF row.
+ */
+bool depotDistances(const int *depots, int nd, int *table, int threads = 0) {
+    if (threads <= 0) threads = (int) thread::hardware_concurrency();
+    if (threads > nd) threads = nd;
+    if (threads < 1) threads = 1;
+
+    PathWorkspace *ws = new PathWorkspace[threads];
+    for (int t = 0; t < threads; t++) {
+        ws[t].reserve();
+        store.reserve(ws[t].parent, Nnodes);
+    }
+    if (!store.commit()) {
+        delete[] ws;
+        return false;
+    }
+
+    atomic<int> nextDepot(0);
+    auto work = [&](int t) {
+        for (int d; (d = nextDepot++) < nd; ) {
+            ws[t].dist = table + (size_t) d * Nnodes;
+            if (depots[d] < 0 || depots[d] >= Nnodes) {
+                for (int r = 0; r < Nnodes; r++) ws[t].dist[r] = INF;
+                continue;
+            }
+            shortestPaths(ws[t], depots[d]);
+        }
+    };
+
+    thread *pool = new thread[threads - 1];
+    for (int t = 1; t < threads; t++) pool[t - 1] = thread(work, t);
+    work(0);
+    for (int t = 1; t < threads; t++) pool[t - 1].join();
+
+    delete[] pool;
+    delete[] ws;
+    return true;
+}
+
 void printRoutePath(int dest) {
     if (dest < 0 || dest >= Nnodes) return;
 
@@ -220,11 +869,10 @@ void printRoutePath(int dest) {
         return;
     }
 
-    int tmp[2000];
     int c = 0, cur = dest;
 
     while (cur != -1) {
-        tmp[c++] = cur;
+        pathBuf[c++] = cur;
         cur = parentBF[cur];
     }
 
@@ -232,22 +880,421 @@ void printRoutePath(int dest) {
     cout << "   Path: ";
 
     for (int i = c - 1; i >= 0; i--) {
-        cout << tmp[i];
+        cout << pathBuf[i];
         if (i) cout << " -> ";
     }
 
     cout << "\n";
 }
 
+/* ============================================================
+   INCREMENTAL ROUTE UPDATES
+   ============================================================ */
+
+/*
+ * Bins can be moved, added (a row whose RouteID is negative gets a route)
+ * or removed (RouteID set negative) without rebuilding the graph:
+ *
+ *   moveBin(i, lat, lon, route);      // any number of changes, then
+ *   updateRouteGraph();               // centroids, kNN edges, distBF/parentBF
+ *
+ * Centroids come from running sums.  Only the routes whose neighbour list
+ * can change are searched again: the changed routes, routes that listed
+ * one of them, and routes whose K-th neighbour is farther away than a
+ * changed route's new centroid.  Changed routes leave the k-d tree for
+ * kdExtra; when that fills up the tree is rebuilt.  The edge list keeps
+ * the order buildRouteGraph gives it.  Route ids must stay below Nnodes;
+ * a new route id needs buildRouteGraph.
+ */
+
+const unsigned char R_DIRTY = 1, R_WAS_ACTIVE = 2, R_AFFECTED = 4;
+
+static double *RsumLat, *RsumLon;      /* Rlat / Rlon times Rcount */
+static unsigned char *routeFlag;
+static int *dirtyList;
+static int dirtyCount = 0;
+static double *oldLat, *oldLon;        /* centroid of a dirty route before its changes */
+static Edge *edgesNext;                /* updateRouteGraph builds the new edge list here */
+static unsigned char *treeState;       /* repairShortestPaths scratch */
+static int *treeStack, *childStart, *treeChild;
+static int activeRoutes = 0;           /* routes with at least one bin */
+
+/* kdMaxKth over [lo, hi) from knnKth; returns the node's value */
+static double kdFillKth(int lo, int hi) {
+    if (hi - lo <= KD_LEAF) {
+        double m = 0;
+        for (int i = lo; i < hi; i++)
+            if (kdPerm[i] >= 0 && knnKth[kdPerm[i]] > m) m = knnKth[kdPerm[i]];
+        return m;
+    }
+    int mid = (lo + hi) / 2;
+    kdMaxKth[mid] = max(kdFillKth(lo, mid), kdFillKth(mid, hi));
+    return kdMaxKth[mid];
+}
+
+/* route r's knnKth grew or shrank: keep kdMaxKth an upper bound */
+static void kdRaiseKth(int r) {
+    int slot = kdSlot[r];
+    if (slot < 0) return;
+    int lo = 0, hi = kdSize;
+    while (hi - lo > KD_LEAF) {
+        int mid = (lo + hi) / 2;
+        if (kdMaxKth[mid] < knnKth[r]) kdMaxKth[mid] = knnKth[r];
+        if (slot < mid) hi = mid; else lo = mid;
+    }
+}
+
+/*
+ * Brings the tree in ws (rooted at src) up to date after the out-arcs of
+ * the routes with changed[r] != 0 were replaced.  A route keeps its
+ * distance while its tree path still exists at no greater cost; the
+ * subtree below a removed or lengthened tree edge is reset.  Reset routes
+ * are seeded from their in-neighbours by a sweep over all arcs (only the
+ * changed routes' arcs when nothing was reset, since that is the only way
+ * a kept distance can shrink), and Dijkstra runs from the seeded routes.
+ * Distances match a fresh shortestPaths; among equally short paths the
+ * parent may differ.
+ */
+void repairShortestPaths(PathWorkspace &ws, int src, const unsigned char *changed) {
+    if (negativeEdges) {
+        shortestPaths(ws, src);
+        return;
+    }
+    const unsigned char KEEP = 0, RESET = 1, SEEDED = 2;
+    int *dist = ws.dist, *parent = ws.parent;
+
+    // children of every route, grouped by parent
+    for (int r = 0; r <= Nnodes; r++) childStart[r] = 0;
+    for (int v = 0; v < Nnodes; v++)
+        if (parent[v] >= 0) childStart[parent[v] + 1]++;
+    for (int r = 0; r < Nnodes; r++) childStart[r + 1] += childStart[r];
+    for (int v = 0; v < Nnodes; v++)
+        if (parent[v] >= 0) treeChild[childStart[parent[v]]++] = v;
+    for (int r = Nnodes; r > 0; r--) childStart[r] = childStart[r - 1];
+    childStart[0] = 0;
+
+    // tree edges out of changed routes that are gone or longer
+    int queued = 0;
+    for (int v = 0; v < Nnodes; v++) {
+        treeState[v] = KEEP;
+        int p = parent[v];
+        if (p < 0 || !changed[p]) continue;
+        bool kept = false;
+        for (int i = outStart[p]; i < outStart[p + 1] && !kept; i++)
+            kept = outArc[i].v == v && outArc[i].w <= dist[v] - dist[p];
+        if (!kept) {
+            treeState[v] = RESET;
+            treeStack[queued++] = v;
+        }
+    }
+    for (int q = 0; q < queued; q++) {
+        int v = treeStack[q];
+        for (int c = childStart[v]; c < childStart[v + 1]; c++)
+            if (treeState[treeChild[c]] != RESET) {
+                treeState[treeChild[c]] = RESET;
+                treeStack[queued++] = treeChild[c];
+            }
+    }
+    bool anyReset = false;
+    for (int v = 0; v < Nnodes; v++)
+        if (treeState[v] == RESET) {
+            dist[v] = INF;
+            parent[v] = -1;
+            anyReset = true;
+        }
+
+    for (int u = 0; u < Nnodes; u++) {
+        if (dist[u] >= INF || (!anyReset && !changed[u])) continue;
+        for (int i = outStart[u]; i < outStart[u + 1]; i++) {
+            const Arc &a = outArc[i];
+            if (dist[u] + a.w < dist[a.v]) {
+                dist[a.v] = dist[u] + a.w;
+                parent[a.v] = u;
+                treeState[a.v] = SEEDED;
+            }
+        }
+    }
+
+    ws.heap.init();
+    for (int v = 0; v < Nnodes; v++)
+        if (treeState[v] == SEEDED) ws.heap.push(dist[v], v);
+    while (!ws.heap.empty()) {
+        unsigned long long k;
+        int u = ws.heap.pop(k);
+        if (k != (unsigned long long) dist[u]) continue;
+        for (int i = outStart[u]; i < outStart[u + 1]; i++) {
+            const Arc &a = outArc[i];
+            int nd = dist[u] + a.w;
+            if (nd < dist[a.v]) {
+                dist[a.v] = nd;
+                parent[a.v] = u;
+                ws.heap.push(nd, a.v);
+            }
+        }
+    }
+}
+
+/* allocates the update state; running sums start from the bin columns */
+bool enableIncremental() {
+    if (incremental) return true;
+    if (Nnodes == 0) return false;
+
+    store.reserve(RsumLat, Nnodes);
+    store.reserve(RsumLon, Nnodes);
+    store.reserve(routeFlag, Nnodes);
+    store.reserve(dirtyList, Nnodes);
+    store.reserve(oldLat, Nnodes);
+    store.reserve(oldLon, Nnodes);
+    store.reserve(edgesNext, edgeCap);
+    store.reserve(treeState, Nnodes);
+    store.reserve(treeStack, Nnodes);
+    store.reserve(childStart, Nnodes + 1);
+    store.reserve(treeChild, Nnodes);
+    if (!store.commit()) return false;
+
+    for (int i = 0; i < BIN_COUNT; i++) {
+        int r = RouteID[i];
+        if (r >= 0 && r < Nnodes) {
+            RsumLat[r] += Lat[i];
+            RsumLon[r] += Lon[i];
+        }
+    }
+    activeRoutes = 0;
+    for (int r = 0; r < Nnodes; r++)
+        if (Rcount[r] > 0) activeRoutes++;
+    kdFillKth(0, kdSize);
+    dirtyCount = 0;
+    incremental = true;
+    return true;
+}
+
+static void markDirty(int r) {
+    if (routeFlag[r] & R_DIRTY) return;
+    routeFlag[r] |= R_DIRTY | (Rcount[r] > 0 ? R_WAS_ACTIVE : 0);
+    oldLat[r] = Rlat[r];
+    oldLon[r] = Rlon[r];
+    dirtyList[dirtyCount++] = r;
+}
+
+static void binDelta(int r, double lat, double lon, int n) {
+    if (r < 0 || r >= Nnodes) return;
+    markDirty(r);
+    RsumLat[r] += n * lat;
+    RsumLon[r] += n * lon;
+    Rcount[r] += n;
+    if (Rcount[r] == 0) RsumLat[r] = RsumLon[r] = 0;   // no rounding residue
+}
+
+/*
+ * Moves bin row i to (lat, lon) on route; route < 0 takes the bin off the
+ * graph.  Takes effect on the next updateRouteGraph.  False for a route
+ * id the graph was not built with.
+ */
+bool moveBin(int i, double lat, double lon, int route) {
+    if (i < 0 || i >= BIN_COUNT || route >= Nnodes) return false;
+    if (!enableIncremental()) return false;
+    if (route < 0) route = -1;
+
+    binDelta(RouteID[i], Lat[i], Lon[i], -1);
+    Lat[i] = lat;
+    Lon[i] = lon;
+    RouteID[i] = route;
+    binDelta(route, lat, lon, 1);
+    return true;
+}
+
+/* routes near a changed route's old or new centroid */
+struct RangeQuery {
+    double p[3];                       // centre as a unit vector
+    double lat, lon, cosLat;           // centre in radians
+    double latDeg, lonDeg;
+    int c;                             // the changed route
+    bool listed;                       // old centre: affected if u lists c
+};
+
+static void setCentre(RangeQuery &rq, double latDeg, double lonDeg) {
+    unitVector(latDeg, lonDeg, rq.p);
+    rq.latDeg = latDeg;
+    rq.lonDeg = lonDeg;
+    rq.lat = deg2rad(latDeg);
+    rq.lon = deg2rad(lonDeg);
+    rq.cosLat = cos(rq.lat);
+}
+
+static void touchRoute(const RangeQuery &rq, int u) {
+    if (u == rq.c || Rcount[u] == 0 || (routeFlag[u] & R_AFFECTED)) return;
+    bool hit = false;
+    if (rq.listed) {
+        for (int i = outStart[u]; i < outStart[u + 1] && !hit; i++)
+            hit = outArc[i].v == rq.c;
+    } else {
+        hit = haversine_m(Rlat[u], Rlon[u], rq.latDeg, rq.lonDeg) <= knnKth[u];
+    }
+    if (hit) routeFlag[u] |= R_AFFECTED;
+}
+
+/*
+ * Touches every tree route u whose knnKth reaches the centre.  bound is a
+ * lower bound on the distance from the centre to [lo, hi); a subtree is
+ * skipped once it exceeds the subtree's kdMaxKth.
+ */
+static void kdRange(const RangeQuery &rq, int lo, int hi, double bound) {
+    if (hi - lo <= KD_LEAF) {
+        double est[KD_LEAF];
+        GeoPoints leaf = { kdLat + lo, kdLon + lo, kdCos + lo };
+        haversineBatch(rq.lat, rq.lon, rq.cosLat, leaf, hi - lo, est);
+
+        for (int i = 0; i < hi - lo; i++) {
+            int u = kdPerm[lo + i];
+            if (u >= 0 && est[i] - havBatchErr(est[i]) <= knnKth[u]) touchRoute(rq, u);
+        }
+        return;
+    }
+
+    int mid = (lo + hi) / 2;
+    if (bound > kdMaxKth[mid]) return;
+    int axis = kdAxis[mid];
+    double gap = rq.p[axis] - kdSplit[mid];
+    bool left = gap < 0;
+
+    if (left) kdRange(rq, lo, mid, bound); else kdRange(rq, mid, hi, bound);
+
+    double far = max(bound, fabs(gap) * EARTH_R * (1.0 - 1e-9) - 1e-6);
+    if (left) kdRange(rq, mid, hi, far); else kdRange(rq, lo, mid, far);
+}
+
+static void touchRoutesNear(const RangeQuery &rq) {
+    kdRange(rq, 0, kdSize, 0);
+    for (int i = 0; i < kdExtraCount; i++) touchRoute(rq, kdExtra[i]);
+}
+
+/* takes route c out of the tree and kdExtra */
+static void leaveSpatialIndex(int c) {
+    if (kdSlot[c] >= 0) {
+        kdPerm[kdSlot[c]] = -1;
+        kdSlot[c] = -1;
+    }
+    for (int i = 0; i < kdExtraCount; i++)
+        if (kdExtra[i] == c) {
+            kdExtra[i] = kdExtra[--kdExtraCount];
+            break;
+        }
+}
+
+/* applies the pending moveBin changes; false if there is no graph */
+bool updateRouteGraph() {
+    if (!incremental) return Nnodes > 0;
+    if (dirtyCount == 0) return true;
+    int K = graphK;
+    int activeBefore = activeRoutes;
+
+    // 1) routes that listed a changed route, found around its old centroid
+    for (int d = 0; d < dirtyCount; d++) {
+        int c = dirtyList[d];
+        if (!(routeFlag[c] & R_WAS_ACTIVE)) continue;
+        RangeQuery rq;
+        setCentre(rq, oldLat[c], oldLon[c]);
+        rq.c = c;
+        rq.listed = true;
+        touchRoutesNear(rq);
+    }
+
+    // 2) new centroids; changed routes move to kdExtra
+    bool rebuildTree = false;
+    for (int d = 0; d < dirtyCount; d++) {
+        int c = dirtyList[d];
+        bool was = routeFlag[c] & R_WAS_ACTIVE;
+        leaveSpatialIndex(c);
+        if (Rcount[c] > 0) {
+            Rlat[c] = RsumLat[c] / Rcount[c];
+            Rlon[c] = RsumLon[c] / Rcount[c];
+            unitVector(Rlat[c], Rlon[c], kdPt[c]);
+            if (kdExtraCount < KD_EXTRA_MAX) kdExtra[kdExtraCount++] = c;
+            else rebuildTree = true;
+            routeFlag[c] |= R_AFFECTED;
+            if (!was) activeRoutes++;
+        } else {
+            Rlat[c] = Rlon[c] = 0;
+            knnKth[c] = 1e18;
+            if (was) activeRoutes--;
+        }
+    }
+    if (rebuildTree) {
+        buildSpatialIndex();
+        kdFillKth(0, kdSize);
+    }
+
+    // 3) routes a changed route now comes close enough to join
+    if (activeRoutes <= K + 1 || activeBefore <= K + 1) {
+        // some lists are short: every route can gain a neighbour
+        for (int r = 0; r < Nnodes; r++) routeFlag[r] |= R_AFFECTED;
+    } else {
+        for (int d = 0; d < dirtyCount; d++) {
+            int c = dirtyList[d];
+            if (Rcount[c] == 0) continue;
+            RangeQuery rq;
+            setCentre(rq, Rlat[c], Rlon[c]);
+            rq.c = c;
+            rq.listed = false;
+            touchRoutesNear(rq);
+        }
+    }
+
+    // 4) new edges for the affected routes.  With K or more other routes
+    //    on both sides every active route has exactly K edges, so the
+    //    lists are rewritten in place; otherwise the edge list is rebuilt.
+    bool sameShape = activeRoutes > K + 1 && activeBefore > K + 1;
+    for (int d = 0; d < dirtyCount && sameShape; d++) {
+        int c = dirtyList[d];
+        sameShape = (bool)(routeFlag[c] & R_WAS_ACTIVE) == (Rcount[c] > 0);
+    }
+    if (sameShape) {
+        for (int u = 0; u < Nnodes; u++) {
+            if (!(routeFlag[u] & R_AFFECTED) || Rcount[u] == 0) continue;
+            int first = outStart[u];
+            routeEdges(u, edges + first);
+            for (int e = first; e < outStart[u + 1]; e++) {
+                outArc[e] = Arc{ edges[e].v, edges[e].w, e };
+                if (edges[e].w < 0) negativeEdges = true;
+            }
+            kdRaiseKth(u);
+        }
+    } else {
+        int E = 0;
+        for (int u = 0; u < Nnodes; u++) {
+            if (Rcount[u] == 0) continue;
+            if (routeFlag[u] & R_AFFECTED) {
+                E += routeEdges(u, edgesNext + E);
+                kdRaiseKth(u);
+            } else {
+                for (int i = outStart[u]; i < outStart[u + 1]; i++)
+                    edgesNext[E++] = Edge{ u, outArc[i].v, outArc[i].w };
+            }
+        }
+        swap(edges, edgesNext);
+        edgeCount = E;
+        indexEdges();
+    }
+
+    // 5) shortest-path tree
+    if (pathSrc >= 0) repairShortestPaths(pathMain, pathSrc, routeFlag);
+
+    for (int r = 0; r < Nnodes; r++) routeFlag[r] = 0;
+    dirtyCount = 0;
+    return true;
+}
+
 /* ============================================================
    WASTE TYPE NORMALIZATION
    ============================================================ */
 
-const char* normalizeWaste(const char* s) {
-    static char buf[32];
+enum WasteCat { W_ORGANIC, W_RECYCLABLE, W_EWASTE, W_HAZARDOUS, W_OTHER, W_CATEGORIES };
+
+WasteCat normalizeWaste(const char* s) {
+    char buf[32];
     int j = 0;
 
-    for (int i = 0; s[i]; i++) {
+    for (int i = 0; s[i] && j < 31; i++) {
         char c = s[i];
         if (c >= 'A' && c <= 'Z') c = c - 'A' + 'a';
         if (c >= 'a' && c <= 'z') buf[j++] = c;
@@ -255,188 +1302,859 @@ const char* normalizeWaste(const char* s) {
 
     buf[j] = 0;
 
-    if (strstr(buf, "organic")) return "organic";
-    if (strstr(buf, "recycl")) return "recyclable";
-    if (strstr(buf, "ewaste") || strstr(buf, "ew")) return "ewaste";
-    if (strstr(buf, "hazard")) return "hazardous";
-    return "other";
+    if (strstr(buf, "organic")) return W_ORGANIC;
+    if (strstr(buf, "recycl")) return W_RECYCLABLE;
+    if (strstr(buf, "ewaste") || strstr(buf, "ew")) return W_EWASTE;
+    if (strstr(buf, "hazard")) return W_HAZARDOUS;
+    return W_OTHER;
 }
 
-/* ============================================================
-   RED–BLACK TREE (TOP 10 LOADS)
-   ============================================================ */
+static unsigned char wasteCatOf[256];  /* category per wasteDict code */
+static int wasteCats[W_CATEGORIES];    /* bins per category */
 
-enum Color { RED, BLACK };
+/* Bins per category into wasteCats: a histogram over WasteCode, then each
+   dictionary entry is normalized once and its count folded into its
+   category. */
+void wasteSegregation() {
+    size_t counts[256];
+    samarthaka::histogram(WasteCode, BIN_COUNT, counts);
 
-struct RB {
-    int pop, id;
-    Color color;
-    RB *left, *right, *parent;
+    for (int c = 0; c < W_CATEGORIES; c++) wasteCats[c] = 0;
+    for (int code = 0; code < wasteDict.size(); code++) {
+        wasteCatOf[code] = normalizeWaste(wasteDict.name(code));
+        wasteCats[wasteCatOf[code]] += (int) counts[code];
+    }
+    if (counts[samarthaka::NO_CODE])
+        for (int i = 0; i < BIN_COUNT; i++)
+            if (WasteCode[i] == samarthaka::NO_CODE) wasteCats[normalizeWaste(Waste[i])]++;
+}
 
-    RB(int p, int i): pop(p), id(i), color(RED),
-        left(NULL), right(NULL), parent(NULL) {}
-};
+WasteCat binWasteCat(int i) {
+    uint8_t c = WasteCode[i];
+    return c == samarthaka::NO_CODE ? normalizeWaste(Waste[i]) : (WasteCat) wasteCatOf[c];
+}
+
+/* ============================================================
+   TOP 10 LOADS (bounded top-K)
+   ============================================================ */
 
-static RB* RBroot = NULL;
+/* key (NearbyPop, row): equal loads list the later row first */
+static samarthaka::TopK<pair<int, int>, int, 10> topLoad;
 static int topPop[10], topId[10], topCnt = 0;
 
-RB* grandp(RB* n) { return n && n->parent ? n->parent->parent : NULL; }
+void buildTopLoads() {
+    topLoad.clear();
+    for (int i = 0; i < BIN_COUNT; i++)
+        topLoad.offer(make_pair(NearbyPop[i], i), i);
+}
+
+/* streaming update: bin row i now has pop people nearby */
+void updateBinLoad(int i, int pop) {
+    if (i < 0 || i >= BIN_COUNT) return;
+    NearbyPop[i] = pop;
+    if (!topLoad.update(make_pair(pop, i), i)) buildTopLoads();
+}
 
-RB* uncle(RB* n) {
-    RB* g = grandp(n);
-    if (!g) return NULL;
-    return (n->parent == g->left ? g->right : g->left);
+void collectTopLoads() {
+    pair<int, int> keys[10];
+    int rows[10];
+    topCnt = topLoad.sorted(keys, rows);
+    for (int i = 0; i < topCnt; i++) {
+        topPop[i] = keys[i].first;
+        topId[i] = BinID[rows[i]];
+    }
 }
 
-void rotateLeftRB(RB*& root, RB* x) {
-    RB* y = x->right;
+/* ============================================================
+   FAULT INDEX (dense / roaring bitmap of BinIDs)
+   ============================================================ */
+
+/* BinIDs are dense integers: a bitset over [min, max] BinID answers a
+   lookup with one load.  IDs outside that range fall back to the
+   roaring layout inside IdBitmap. */
+static samarthaka::IdBitmap faultIdx;
 
-    x->right = y->left;
-    if (y->left) y->left->parent = x;
+/* zone code -> BinIDs in that zone.  Each zone holds only its share of
+   the IDs, so these stay sparse (roaring chunks) instead of one dense
+   range-sized bitset per zone. */
+static samarthaka::IdBitmap zoneBins[samarthaka::StringDict::MAX_CODES];
 
-    y->parent = x->parent;
+void faultInsert(int key) { faultIdx.insert((uint32_t) key); }
 
-    if (!x->parent) root = y;
-    else if (x == x->parent->left) x->parent->left = y;
-    else x->parent->right = y;
+bool faultSearch(int key) { return faultIdx.contains((uint32_t) key); }
 
-    y->left = x;
-    x->parent = y;
+bool isFaultStatus(const char *s) {
+    return strcmp(s, "FAIL") == 0 || strcmp(s, "FAULT") == 0;
 }
 
-void rotateRightRB(RB*& root, RB* x) {
-    RB* y = x->left;
+/* per sensorDict code, filled by buildFaultIndex */
+static bool faultyCode[256];
 
-    x->left = y->right;
-    if (y->right) y->right->parent = x;
+bool sensorFaulty(int i) {
+    uint8_t c = SensorCode[i];
+    return c == samarthaka::NO_CODE ? isFaultStatus(Sensor[i]) : faultyCode[c];
+}
 
-    y->parent = x->parent;
+/* Sizes the fault index from the BinID range and fills the zone sets. */
+void buildFaultIndex() {
+    int lo = INF, hi = -INF;
+    for (int i = 0; i < BIN_COUNT; i++) {
+        lo = min(lo, BinID[i]);
+        hi = max(hi, BinID[i]);
+    }
+    if (lo >= 0 && hi >= lo) faultIdx.reset(lo, (uint32_t) hi + 1);
+    else faultIdx.clear();      // negative IDs: stay sparse
 
-    if (!x->parent) root = y;
-    else if (x == x->parent->left) x->parent->left = y;
-    else x->parent->right = y;
+    for (int c = 0; c < sensorDict.size(); c++)
+        faultyCode[c] = isFaultStatus(sensorDict.name(c));
+    for (int z = 0; z < zoneDict.size(); z++)
+        zoneBins[z].clear();
+    for (int i = 0; i < BIN_COUNT; i++)
+        if (ZoneCode[i] != samarthaka::NO_CODE)
+            zoneBins[ZoneCode[i]].insert((uint32_t) BinID[i]);
+}
 
-    y->right = x;
-    x->parent = y;
+/* All faulty bins in zone, ascending BinID; writes up to cap of them to
+   out and returns the total count. */
+int faultyInZone(const char *zone, int *out, int cap) {
+    int z = zoneDict.find(zone);
+    if (z < 0) return 0;
+    int n = 0;
+    zoneBins[z].forEachAnd(faultIdx, [&](uint32_t id) {
+        if (n < cap) out[n] = (int) id;
+        n++;
+    });
+    return n;
 }
 
-void fixInsertRB(RB*& root, RB* n) {
-    while (n != root && n->parent->color == RED) {
-        RB* u = uncle(n);
-        RB* g = grandp(n);
+/* ============================================================
+   TRUCK TOURS (CVRP: savings + 2-opt / Or-opt)
+   ============================================================ */
 
-        if (u && u->color == RED) {
-            n->parent->color = BLACK;
-            u->color = BLACK;
-            g->color = RED;
-            n = g;
-        } else {
-            if (n->parent == g->left) {
-                if (n == n->parent->right) {
-                    n = n->parent;
-                    rotateLeftRB(root, n);
+/*
+ * Capacitated tours from one depot route's centroid over every bin on the
+ * graph.  A bin's load is estimated from NearbyPop.  Clarke-Wright
+ * savings builds the tours, then each tour is improved by 2-opt and
+ * Or-opt (segments of 1-3 bins) on its own thread.  Both steps only look
+ * at CVRP_NEIGH nearest bins per bin, with don't-look bits in the local
+ * search, so nothing is quadratic in the bin count.  RouteIDs in the data
+ * are not spatial clusters, so neighbours come from a grid over the bins
+ * rather than from the route graph.  Tour cost is great-circle metres
+ * (chord of unit vectors, same value as haversine_m without the trig).
+ */
+
+const int CVRP_NEIGH = 12;
+const double LOAD_KG_PER_RESIDENT = 0.045;   /* 0.45 kg/person/day, ~10 bins share it */
+
+static int cvN = 0;                    /* customers: bins with a route */
+static int *cvBin;                     /* customer -> bin row */
+static int *cvLoad;                    /* kg */
+static double cvDepotLat, cvDepotLon;
+static double (*cvPt)[3];              /* unit vector per customer, depot at [cvN] */
+static int *cvNbr;                     /* CVRP_NEIGH nearest customers each, -1 padded */
+static int *cvTour;                    /* tour -> first slot in cvSeq */
+static int *cvSeq;                     /* tours back to back, depot implicit at both ends */
+static int *cvTourOf;                  /* customer -> tour */
+static int cvTours = 0;
+
+int binLoadKg(int i) {
+    int kg = (int) ceil(NearbyPop[i] * LOAD_KG_PER_RESIDENT);
+    return kg > 0 ? kg : 1;
+}
+
+/* customer a to b in metres; -1 is the depot */
+static inline double cvDist(int a, int b) {
+    const double *p = cvPt[a < 0 ? cvN : a], *q = cvPt[b < 0 ? cvN : b];
+    double dx = p[0] - q[0], dy = p[1] - q[1], dz = p[2] - q[2];
+    double half = 0.5 * sqrt(dx * dx + dy * dy + dz * dz);
+    return 2.0 * EARTH_R * asin(half < 1.0 ? half : 1.0);
+}
+
+/* CVRP_NEIGH nearest customers per customer, by ring search over a grid
+   (local equirectangular metres; only the ranking matters here) */
+static void cvBuildNeighbours(double *px, double *py, int *cellStart, int *cellItem) {
+    double mnx = 1e300, mny = 1e300, mxx = -1e300, mxy = -1e300;
+    double cos0 = cos(deg2rad(cvDepotLat));
+    for (int c = 0; c < cvN; c++) {
+        px[c] = deg2rad(Lon[cvBin[c]]) * cos0 * EARTH_R;
+        py[c] = deg2rad(Lat[cvBin[c]]) * EARTH_R;
+        mnx = min(mnx, px[c]); mxx = max(mxx, px[c]);
+        mny = min(mny, py[c]); mxy = max(mxy, py[c]);
+    }
+    // about two customers per cell
+    double area = max((mxx - mnx) * (mxy - mny), 1.0);
+    double cell = max(sqrt(area * 2.0 / cvN), 1.0);
+    int gx, gy;
+    for (;; cell *= 1.5) {
+        // degenerate (line-shaped) spreads would otherwise need more cells than customers
+        gx = (int)((mxx - mnx) / cell) + 1;
+        gy = (int)((mxy - mny) / cell) + 1;
+        if ((long long) gx * gy <= 2LL * cvN + 2) break;
+    }
+
+    auto cellOf = [&](int c, int &cx, int &cy) {
+        cx = min((int)((px[c] - mnx) / cell), gx - 1);
+        cy = min((int)((py[c] - mny) / cell), gy - 1);
+    };
+    for (int k = 0; k <= gx * gy; k++) cellStart[k] = 0;
+    for (int c = 0; c < cvN; c++) {
+        int cx, cy;
+        cellOf(c, cx, cy);
+        cellStart[cy * gx + cx + 1]++;
+    }
+    for (int k = 0; k < gx * gy; k++) cellStart[k + 1] += cellStart[k];
+    for (int c = 0; c < cvN; c++) {
+        int cx, cy;
+        cellOf(c, cx, cy);
+        cellItem[cellStart[cy * gx + cx]++] = c;
+    }
+    for (int k = gx * gy; k > 0; k--) cellStart[k] = cellStart[k - 1];
+    cellStart[0] = 0;
+
+    for (int c = 0; c < cvN; c++) {
+        double bestD[CVRP_NEIGH];
+        int *best = cvNbr + (size_t) c * CVRP_NEIGH, cnt = 0;
+        int cx, cy;
+        cellOf(c, cx, cy);
+        for (int ring = 0; ; ring++) {
+            // every customer outside this ring is at least ring * cell away
+            if (cnt == CVRP_NEIGH && bestD[cnt - 1] <= (ring - 1) * cell) break;
+            if (ring > gx && ring > gy) break;
+            for (int y = cy - ring; y <= cy + ring; y++) {
+                if (y < 0 || y >= gy) continue;
+                bool edge = y == cy - ring || y == cy + ring;
+                for (int x = cx - ring; x <= cx + ring; x += (edge || ring == 0) ? 1 : 2 * ring) {
+                    if (x < 0 || x >= gx) continue;
+                    for (int k = cellStart[y * gx + x]; k < cellStart[y * gx + x + 1]; k++) {
+                        int o = cellItem[k];
+                        if (o == c) continue;
+                        double dx = px[o] - px[c], dy = py[o] - py[c];
+                        double d = sqrt(dx * dx + dy * dy);
+                        if (cnt == CVRP_NEIGH && d >= bestD[cnt - 1]) continue;
+                        int t = cnt < CVRP_NEIGH ? cnt++ : cnt - 1;
+                        while (t > 0 && bestD[t - 1] > d) {
+                            bestD[t] = bestD[t - 1];
+                            best[t] = best[t - 1];
+                            t--;
+                        }
+                        bestD[t] = d;
+                        best[t] = o;
+                    }
                 }
-                n->parent->color = BLACK;
-                g->color = RED;
-                rotateRightRB(root, g);
+            }
+        }
+        for (int t = cnt; t < CVRP_NEIGH; t++) best[t] = -1;
+    }
+}
+
+struct Saving { double s; int i, j; };
+
+/* Clarke-Wright: merge tours end to end in order of saving while the load fits */
+static void cvSavings(int cap, Saving *sv, int *nxt, int *prv, int *uf, int *tHead, int *tTail, int *tLoad) {
+    int ns = 0;
+    for (int i = 0; i < cvN; i++) {
+        double di = cvDist(-1, i);
+        for (int t = 0; t < CVRP_NEIGH; t++) {
+            int j = cvNbr[(size_t) i * CVRP_NEIGH + t];
+            if (j > i) sv[ns++] = Saving{ di + cvDist(-1, j) - cvDist(i, j), i, j };
+            else if (j >= 0) {
+                // keep (j, i) once: skip it here if i is also in j's list
+                bool dup = false;
+                for (int u = 0; u < CVRP_NEIGH && !dup; u++) dup = cvNbr[(size_t) j * CVRP_NEIGH + u] == i;
+                if (!dup) sv[ns++] = Saving{ di + cvDist(-1, j) - cvDist(i, j), j, i };
+            }
+        }
+    }
+    sort(sv, sv + ns, [](const Saving &a, const Saving &b) {
+        return a.s != b.s ? a.s > b.s : (a.i != b.i ? a.i < b.i : a.j < b.j);
+    });
+
+    for (int c = 0; c < cvN; c++) {
+        nxt[c] = prv[c] = -1;
+        uf[c] = c;
+        tHead[c] = tTail[c] = c;
+        tLoad[c] = cvLoad[c];
+    }
+    auto find = [uf](int x) {
+        while (uf[x] != x) x = uf[x] = uf[uf[x]];
+        return x;
+    };
+    // reverses tour r in place
+    auto reverse = [&](int r) {
+        for (int c = tHead[r]; c >= 0; c = prv[c]) swap(nxt[c], prv[c]);
+        swap(tHead[r], tTail[r]);
+    };
+    auto size = [&](int r) {
+        int n = 0;
+        for (int c = tHead[r]; c >= 0; c = nxt[c]) n++;
+        return n;
+    };
+
+    for (int k = 0; k < ns; k++) {
+        if (sv[k].s <= 0) break;
+        int i = sv[k].i, j = sv[k].j;
+        int a = find(i), b = find(j);
+        if (a == b || tLoad[a] + tLoad[b] > cap) continue;
+        bool iHead = tHead[a] == i, iTail = tTail[a] == i;
+        bool jHead = tHead[b] == j, jTail = tTail[b] == j;
+        if (!(iHead || iTail) || !(jHead || jTail)) continue;
+
+        // orient so that ... a-tail i -> j b-head ...
+        if (!iTail && !jHead) {
+            // i is a's head and j is b's tail: b then a
+            swap(a, b);
+        } else if (!iTail) {
+            reverse(a);
+        } else if (!jHead) {
+            if (size(a) < size(b)) {
+                reverse(a);
+                swap(a, b);
             } else {
-                if (n == n->parent->left) {
-                    n = n->parent;
-                    rotateRightRB(root, n);
-                }
-                n->parent->color = BLACK;
-                g->color = RED;
-                rotateLeftRB(root, g);
+                reverse(b);
             }
         }
+        nxt[tTail[a]] = tHead[b];
+        prv[tHead[b]] = tTail[a];
+        tTail[a] = tTail[b];
+        tLoad[a] += tLoad[b];
+        uf[b] = a;
     }
 
-    root->color = BLACK;
+    cvTours = 0;
+    int slot = 0;
+    for (int c = 0; c < cvN; c++) {
+        if (find(c) != c) continue;
+        cvTour[cvTours] = slot;
+        for (int x = tHead[c]; x >= 0; x = nxt[x]) {
+            cvTourOf[x] = cvTours;
+            cvSeq[slot++] = x;
+        }
+        cvTours++;
+    }
+    cvTour[cvTours] = slot;
 }
 
-void RBinsert(int pop, int id) {
-    RB* n = new RB(pop, id);
-    RB* cur = RBroot;
-    RB* par = NULL;
+/*
+ * 2-opt and Or-opt inside one tour.  T[0] and T[m + 1] are the depot; pos
+ * maps a customer back to its index in T.  Customers wait on a work stack
+ * (their don't-look bit cleared) and are re-queued when a move touches
+ * one of their edges.
+ */
+struct TourSearch {
+    int tour;
+    int *T, m;
+    int *pos;
+    unsigned char *dontLook;
+    int *work, nwork;
+
+    void wake(int c) {
+        if (c >= 0 && dontLook[c]) {
+            dontLook[c] = 0;
+            work[nwork++] = c;
+        }
+    }
 
-    while (cur) {
-        par = cur;
-        if (pop < cur->pop) cur = cur->left;
-        else cur = cur->right;
+    void reverseRange(int i, int j) {
+        for (; i < j; i++, j--) {
+            swap(T[i], T[j]);
+            pos[T[i]] = i;
+            pos[T[j]] = j;
+        }
+        if (i == j) pos[T[i]] = i;
     }
 
-    n->parent = par;
+    // edges (T[i], T[i+1]) and (T[j], T[j+1]), i < j
+    bool twoOpt(int i, int j) {
+        if (i < 0 || j > m || j <= i + 1) return false;
+        int a = T[i], b = T[i + 1], c = T[j], d = T[j + 1];
+        double gain = cvDist(a, b) + cvDist(c, d) - cvDist(a, c) - cvDist(b, d);
+        if (gain <= 1e-7) return false;
+        reverseRange(i + 1, j);
+        wake(a); wake(b); wake(c); wake(d);
+        return true;
+    }
 
-    if (!par) RBroot = n;
-    else if (pop < par->pop) par->left = n;
-    else par->right = n;
+    // moves T[s..e] into edge (T[k], T[k+1]), reversed if rev
+    bool orOpt(int s, int e, int k, bool rev) {
+        if (s < 1 || e > m || (k >= s - 1 && k <= e)) return false;
+        int p = T[s - 1], n = T[e + 1], u = T[k], v = T[k + 1];
+        int first = rev ? T[e] : T[s], last = rev ? T[s] : T[e];
+        double gain = cvDist(p, T[s]) + cvDist(T[e], n) + cvDist(u, v)
+                    - cvDist(p, n) - cvDist(u, first) - cvDist(last, v);
+        if (gain <= 1e-7) return false;
+
+        int L = e - s + 1, seg[3];
+        for (int t = 0; t < L; t++) seg[t] = T[s + t];
+        int at;
+        if (k > e) {
+            for (int x = e + 1; x <= k; x++) { T[x - L] = T[x]; pos[T[x - L]] = x - L; }
+            at = k - L + 1;
+        } else {
+            for (int x = s - 1; x > k; x--) { T[x + L] = T[x]; pos[T[x + L]] = x + L; }
+            at = k + 1;
+        }
+        for (int t = 0; t < L; t++) {
+            T[at + t] = rev ? seg[L - 1 - t] : seg[t];
+            pos[T[at + t]] = at + t;
+        }
+        wake(p); wake(n); wake(u); wake(v); wake(first); wake(last);
+        return true;
+    }
+
+    bool improve(int a) {
+        int p = pos[a];
+        // every move below swaps an edge at a for a-c; neighbours are
+        // nearest first, so stop once a-c is no shorter than both of a's edges
+        double reach = max(cvDist(T[p - 1], a), cvDist(a, T[p + 1]));
+        for (int t = 0; t < CVRP_NEIGH; t++) {
+            int c = cvNbr[(size_t) a * CVRP_NEIGH + t];
+            if (c < 0 || cvDist(a, c) >= reach) break;
+            if (cvTourOf[c] != tour) continue;
+            int q = pos[c];
+
+            // 2-opt moves that create the edge a-c
+            if (twoOpt(min(p, q), max(p, q))) return true;
+            if (twoOpt(min(p, q) - 1, max(p, q) - 1)) return true;
+
+            // Or-opt: a segment starting or ending at a goes next to c
+            for (int L = 1; L <= 3; L++) {
+                for (int dir = 0; dir < 2; dir++) {
+                    int s = dir ? p - L + 1 : p, e = s + L - 1;
+                    if (s < 1 || e > m) continue;
+                    for (int k = q - 1; k <= q; k++)
+                        for (int rev = 0; rev < 2; rev++) {
+                            int first = rev ? e : s, last = rev ? s : e;
+                            // a must end up next to c
+                            bool adj = (k == q && T[first] == a) || (k == q - 1 && T[last] == a);
+                            if (adj && orOpt(s, e, k, rev)) return true;
+                        }
+                }
+            }
+        }
+        return false;
+    }
+
+    void run() {
+        nwork = 0;
+        for (int i = m; i >= 1; i--) {
+            dontLook[T[i]] = 1;
+            wake(T[i]);
+        }
+        while (nwork > 0) {
+            int a = work[--nwork];
+            dontLook[a] = 1;
+            if (improve(a)) wake(a);
+        }
+    }
+};
 
-    fixInsertRB(RBroot, n);
+static double cvTourLength(int t) {
+    double len = 0;
+    int prev = -1;
+    for (int s = cvTour[t]; s < cvTour[t + 1]; s++) {
+        len += cvDist(prev, cvSeq[s]);
+        prev = cvSeq[s];
+    }
+    return len + cvDist(prev, -1);
+}
+
+static double cvTotalLength() {
+    double len = 0;
+    for (int t = 0; t < cvTours; t++) len += cvTourLength(t);
+    return len;
 }
 
-void collectTopRB(RB* node) {
-    if (!node || topCnt >= 10) return;
-    collectTopRB(node->right);
-    if (topCnt < 10) {
-        topPop[topCnt] = node->pop;
-        topId[topCnt] = node->id;
-        topCnt++;
+/*
+ * Builds and prints truck tours of capacity cap kg from depotRoute's
+ * centroid.  threads = 0: one per core.
+ */
+bool truckTours(int depotRoute, int cap, int threads = 0) {
+    if (depotRoute < 0 || depotRoute >= Nnodes || Rcount[depotRoute] == 0) {
+        cout << "ERROR: depot route " << depotRoute << " has no bins\n";
+        return false;
+    }
+    cvDepotLat = Rlat[depotRoute];
+    cvDepotLon = Rlon[depotRoute];
+
+    cvN = 0;
+    for (int i = 0; i < BIN_COUNT; i++) cvN += RouteID[i] >= 0;
+    if (cvN == 0) return true;
+
+    double *px, *py;
+    int *cellStart, *cellItem, *nxt, *prv, *uf, *tHead, *tTail, *tLoad, *pos, *work;
+    unsigned char *dontLook;
+    Saving *sv;
+    store.reserve(cvBin, cvN);
+    store.reserve(cvLoad, cvN);
+    store.reserve(cvPt, cvN + 1);
+    store.reserve(cvNbr, (size_t) cvN * CVRP_NEIGH);
+    store.reserve(cvTour, cvN + 1);
+    store.reserve(cvSeq, cvN);
+    store.reserve(cvTourOf, cvN);
+    store.reserve(px, cvN);
+    store.reserve(py, cvN);
+    store.reserve(cellStart, 2 * (size_t) cvN + 3);      // grid cells + 1, see cvBuildNeighbours
+    store.reserve(cellItem, cvN);
+    store.reserve(sv, (size_t) cvN * CVRP_NEIGH);
+    store.reserve(nxt, cvN);
+    store.reserve(prv, cvN);
+    store.reserve(uf, cvN);
+    store.reserve(tHead, cvN);
+    store.reserve(tTail, cvN);
+    store.reserve(tLoad, cvN);
+    store.reserve(pos, cvN);
+    store.reserve(work, cvN);
+    store.reserve(dontLook, cvN);
+    if (!store.commit()) {
+        cout << "ERROR: out of memory for " << cvN << " tour stops\n";
+        return false;
+    }
+
+    long long totalLoad = 0;
+    int over = 0;
+    unitVector(cvDepotLat, cvDepotLon, cvPt[cvN]);
+    for (int i = 0, c = 0; i < BIN_COUNT; i++) {
+        if (RouteID[i] < 0) continue;
+        cvBin[c] = i;
+        cvLoad[c] = binLoadKg(i);
+        unitVector(Lat[i], Lon[i], cvPt[c]);
+        totalLoad += cvLoad[c];
+        over += cvLoad[c] > cap;       // such a bin gets a truck to itself
+        c++;
+    }
+
+    cvBuildNeighbours(px, py, cellStart, cellItem);
+    cvSavings(cap, sv, nxt, prv, uf, tHead, tTail, tLoad);
+    double built = cvTotalLength();
+
+    // local search: tours are independent, so threads take whole tours
+    if (threads <= 0) threads = (int) thread::hardware_concurrency();
+    if (threads > cvTours) threads = cvTours;
+    if (threads < 1) threads = 1;
+    atomic<int> nextTour(0);
+    auto search = [&]() {
+        for (int t; (t = nextTour++) < cvTours; ) {
+            // cvSeq has no depot slots: search a copy with T[0] and T[m + 1] = depot
+            int m = cvTour[t + 1] - cvTour[t];
+            int *T = new int[m + 2];
+            T[0] = T[m + 1] = -1;
+            for (int s = 0; s < m; s++) {
+                T[s + 1] = cvSeq[cvTour[t] + s];
+                pos[T[s + 1]] = s + 1;
+            }
+            TourSearch ts{ t, T, m, pos, dontLook, work + cvTour[t], 0 };
+            ts.run();
+            for (int s = 0; s < m; s++) cvSeq[cvTour[t] + s] = T[s + 1];
+            delete[] T;
+        }
+    };
+    thread *pool = new thread[threads - 1];
+    for (int t = 1; t < threads; t++) pool[t - 1] = thread(search);
+    search();
+    for (int t = 1; t < threads; t++) pool[t - 1].join();
+    delete[] pool;
+    double improved = cvTotalLength();
+
+    cout << "=== TRUCK TOURS (CVRP, capacity " << cap << " kg) ===\n";
+    cout << "Depot: route " << depotRoute << " (" << fixed << setprecision(4)
+         << cvDepotLat << ", " << cvDepotLon << ")   Bins: " << cvN
+         << "   Load: " << totalLoad << " kg\n";
+    if (over) cout << "Bins over capacity (served alone): " << over << "\n";
+    cout << setprecision(1);
+    cout << "Savings:          " << cvTours << " trucks, " << built / 1000 << " km\n";
+    cout << "2-opt + Or-opt:   " << cvTours << " trucks, " << improved / 1000 << " km\n";
+    cout << "Truck | Bins | Load kg | Length km\n";
+    for (int t = 0; t < cvTours && t < 10; t++) {
+        int load = 0;
+        for (int s = cvTour[t]; s < cvTour[t + 1]; s++) load += cvLoad[cvSeq[s]];
+        cout << setw(5) << t + 1 << " | " << setw(4) << cvTour[t + 1] - cvTour[t] << " | "
+             << setw(7) << load << " | " << setw(9) << cvTourLength(t) / 1000 << "\n";
     }
-    collectTopRB(node->left);
+    cout << setprecision(4) << "\n";
+    return true;
 }
 
 /* ============================================================
-   SKIP LIST FOR FAULT DETECTION
+   STREAMING SENSOR FEED
    ============================================================ */
 
-struct SL {
-    int key;
-    SL *next, *down;
-    SL(int k): key(k), next(NULL), down(NULL) {}
+/*
+ * --stream reads an append-only event feed (a file, or - for stdin) after
+ * the batch report, one event per line:
+ *
+ *   pop,<BinID>,<NearbyPopulation>
+ *   sensor,<BinID>,<SensorStatus>
+ *   waste,<BinID>,<WasteType>
+ *   move,<BinID>,<Latitude>,<Longitude>,<RouteID>
+ *
+ * Blank lines and lines starting with # are skipped.  BinIDs need not be
+ * unique: an event applies to every row with that BinID.  Each event updates
+ * the columns in place together with the waste histogram, the top-10
+ * loads, the fault index and (for moves) the route graph, and a delta
+ * report is printed every N events and/or S seconds.  With --follow the
+ * reader waits for more lines at end of file instead of stopping.
+ */
+
+struct RunOptions {
+    const char *path = NULL;           // NULL: batch run only
+    long every = 1000;                 // events per report (0: off)
+    double seconds = 0;                // seconds per report (0: off)
+    bool follow = false;
+    int truckKg = 0;                   // --cvrp: truck capacity in kg (0: no tours)
+};
+
+/* (BinID, row) sorted by BinID, for events that name a bin */
+static pair<int, int> *binIndex;
+
+bool buildBinIndex() {
+    store.reserve(binIndex, BIN_COUNT);
+    if (!store.commit()) return false;
+    for (int i = 0; i < BIN_COUNT; i++) binIndex[i] = make_pair(BinID[i], i);
+    sort(binIndex, binIndex + BIN_COUNT);
+    return true;
+}
+
+/* binIndex entries [*lo, *hi) are the rows with BinID id; false if none */
+bool binRows(int id, int *lo, int *hi) {
+    pair<int, int> *p = lower_bound(binIndex, binIndex + BIN_COUNT, make_pair(id, -1));
+    pair<int, int> *q = upper_bound(p, binIndex + BIN_COUNT, make_pair(id, BIN_COUNT));
+    *lo = (int) (p - binIndex);
+    *hi = (int) (q - binIndex);
+    return *lo < *hi;
+}
+
+/* what changed since the last report */
+struct StreamDelta {
+    long events, rejected;
+    int cats[W_CATEGORIES];            // wasteCats at the last report
+    int newFaults, clearedFaults;
+    int zoneFaults[samarthaka::StringDict::MAX_CODES];   // faulty bins per zone at the last report
+    int moves;
+    int topId[10], topPop[10], topCnt;
 };
 
-static SL* SLhead = new SL(-1);
+static void startDelta(StreamDelta &d) {
+    d.events = d.rejected = 0;
+    for (int c = 0; c < W_CATEGORIES; c++) d.cats[c] = wasteCats[c];
+    d.newFaults = d.clearedFaults = d.moves = 0;
+    for (int z = 0; z < zoneDict.size(); z++) d.zoneFaults[z] = faultyInZone(zoneDict.name(z), NULL, 0);
+    collectTopLoads();
+    d.topCnt = topCnt;
+    for (int i = 0; i < topCnt; i++) {
+        d.topId[i] = topId[i];
+        d.topPop[i] = topPop[i];
+    }
+}
+
+/* splits line at commas in place; returns the field count */
+static int splitFields(char *line, char **f, int maxf) {
+    int n = 0;
+    char *p = line;
+    while (n < maxf) {
+        f[n++] = p;
+        p = strchr(p, ',');
+        if (!p) break;
+        *p++ = 0;
+    }
+    return n;
+}
+
+static void setText(char *dst, int width, const char *src) {
+    strncpy(dst, src, width - 1);
+    dst[width - 1] = 0;
+}
+
+/* applies one event line; false if it is malformed or names an unknown bin */
+bool applyEvent(char *line, StreamDelta &d) {
+    char *f[6];
+    int n = splitFields(line, f, 6);
+    if (n < 3) return false;
+    int id = atoi(f[1]), lo, hi;
+    if (!binRows(id, &lo, &hi)) return false;
+
+    if (strcmp(f[0], "pop") == 0) {
+        for (int k = lo; k < hi; k++) updateBinLoad(binIndex[k].second, atoi(f[2]));
+    } else if (strcmp(f[0], "sensor") == 0) {
+        // the fault index is keyed by BinID: faulty while any of its rows is
+        bool was = faultSearch(id), now = false;
+        for (int k = lo; k < hi; k++) {
+            int i = binIndex[k].second;
+            setText(Sensor[i], sizeof(Sensor[i]), f[2]);
+            uint8_t c = sensorDict.intern(Sensor[i]);
+            if (c != samarthaka::NO_CODE) faultyCode[c] = isFaultStatus(sensorDict.name(c));
+            SensorCode[i] = c;
+            now = now || sensorFaulty(i);
+        }
+
+        if (now && !was) {
+            faultInsert(id);
+            d.newFaults++;
+        } else if (was && !now) {
+            faultIdx.erase((uint32_t) id);
+            d.clearedFaults++;
+        }
+    } else if (strcmp(f[0], "waste") == 0) {
+        for (int k = lo; k < hi; k++) {
+            int i = binIndex[k].second;
+            wasteCats[binWasteCat(i)]--;
+            setText(Waste[i], sizeof(Waste[i]), f[2]);
+            uint8_t c = wasteDict.intern(Waste[i]);
+            if (c != samarthaka::NO_CODE) wasteCatOf[c] = normalizeWaste(wasteDict.name(c));
+            WasteCode[i] = c;
+            wasteCats[binWasteCat(i)]++;
+        }
+    } else if (strcmp(f[0], "move") == 0) {
+        if (n < 5) return false;
+        // moveBin only fails on the route id or graph setup, so the first
+        // row rejects the event before any row has moved
+        for (int k = lo; k < hi; k++) {
+            if (!moveBin(binIndex[k].second, atof(f[2]), atof(f[3]), atoi(f[4]))) return false;
+            d.moves++;
+        }
+    } else {
+        return false;
+    }
+    return true;
+}
+
+void streamReport(int seq, StreamDelta &d) {
+    static const char *catName[W_CATEGORIES] = {
+        "Organic", "Recyclable", "E-waste", "Hazardous", "Other"
+    };
 
-void SLinsert(int key) {
-    SL* update[20];
-    SL* cur = SLhead;
-    int lvl = 0;
+    cout << "=== STREAM REPORT #" << seq << " ===\n";
+    cout << "Events applied: " << d.events - d.rejected << "   Rejected: " << d.rejected << "\n";
+
+    cout << "Waste:";
+    for (int c = 0; c < W_CATEGORIES; c++) {
+        int delta = wasteCats[c] - d.cats[c];
+        cout << "  " << catName[c] << " " << wasteCats[c];
+        if (delta) cout << " (" << showpos << delta << noshowpos << ")";
+    }
+    cout << "\n";
+
+    cout << "Faulty bins: " << faultIdx.size()
+         << "  (+" << d.newFaults << " new, -" << d.clearedFaults << " cleared)\n";
+    cout << "Faulty by zone:";
+    for (int z = 0; z < zoneDict.size(); z++) {
+        int now = faultyInZone(zoneDict.name(z), NULL, 0), delta = now - d.zoneFaults[z];
+        cout << "  " << zoneDict.name(z) << " " << now;
+        if (delta) cout << " (" << showpos << delta << noshowpos << ")";
+    }
+    cout << "\n";
 
-    while (cur) {
-        while (cur->next && cur->next->key < key) cur = cur->next;
-        update[lvl++] = cur;
-        cur = cur->down;
+    if (d.moves) {
+        updateRouteGraph();
+        int reach = 0;
+        for (int r = 0; r < Nnodes; r++) reach += distBF[r] < INF;
+        cout << "Route graph: " << d.moves << " bin moves applied, edges=" << edgeCount
+             << ", reachable from depot (" << pathSrc << ")=" << reach << "\n";
     }
 
-    SL* downNode = NULL;
-    bool promote = true;
+    collectTopLoads();
+    bool same = topCnt == d.topCnt;
+    for (int i = 0; i < topCnt && same; i++)
+        same = topId[i] == d.topId[i] && topPop[i] == d.topPop[i];
+    if (same) {
+        cout << "Top 10 loads unchanged\n";
+    } else {
+        cout << "Top 10 loads:\nRank | BinID | NearbyPop\n";
+        for (int i = 0; i < topCnt; i++)
+            cout << setw(4) << i+1 << " | " << setw(5) << topId[i] << " | " << setw(9) << topPop[i] << "\n";
+    }
+    cout << "\n" << flush;
+
+    startDelta(d);
+}
+
+/* consumes the feed until end of input (never, with follow) */
+int runStream(const RunOptions &so) {
+    FILE *in = strcmp(so.path, "-") == 0 ? stdin : fopen(so.path, "r");
+    if (!in) {
+        cout << "ERROR: cannot open " << so.path << "\n";
+        return 1;
+    }
+    if (!buildBinIndex()) {
+        cout << "ERROR: out of memory for the bin index\n";
+        return 1;
+    }
+
+    cout << "=== STREAMING " << (in == stdin ? "stdin" : so.path) << " ===\n\n" << flush;
+
+    StreamDelta d;
+    startDelta(d);
+    int seq = 0;
+    auto last = chrono::steady_clock::now();
+    char line[256];
+    size_t have = 0;                   // start of a line still being written
+
+    while (true) {
+        bool got = fgets(line + have, sizeof(line) - have, in) != NULL;
+        if (got) {
+            size_t len = have + strlen(line + have);
+            have = 0;
+            bool whole = len > 0 && line[len - 1] == '\n';
+            if (!whole && len == sizeof(line) - 1) {
+                // longer than any event: drop the rest of it
+                int ch;
+                while ((ch = fgetc(in)) != EOF && ch != '\n') {}
+                d.events++;
+                d.rejected++;
+            } else if (!whole && so.follow) {
+                have = len;            // wait for the writer to finish it
+                got = false;
+            } else {
+                while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = 0;
+                if (len > 0 && line[0] != '#') {
+                    d.events++;
+                    if (!applyEvent(line, d)) d.rejected++;
+                }
+            }
+        }
 
-    for (int i = 0; i < lvl && promote; i++) {
-        SL* n = new SL(key);
-        n->next = update[i]->next;
-        update[i]->next = n;
-        n->down = downNode;
-        downNode = n;
+        bool due = so.every > 0 && d.events >= so.every;
+        if (so.seconds > 0 && d.events > 0 &&
+            chrono::duration<double>(chrono::steady_clock::now() - last).count() >= so.seconds)
+            due = true;
+        if (!got && d.events > 0 && !so.follow) due = true;
+        if (due) {
+            streamReport(++seq, d);
+            last = chrono::steady_clock::now();
+        }
 
-        promote = (rand() % 2 == 0);
+        if (!got) {
+            if (!so.follow) break;
+            clearerr(in);
+            this_thread::sleep_for(chrono::milliseconds(200));
+        }
     }
+
+    if (in != stdin) fclose(in);
+    cout << "=== END OF STREAM (" << seq << " reports) ===\n";
+    return 0;
 }
 
-bool SLsearch(int key) {
-    SL* cur = SLhead;
-    while (cur) {
-        while (cur->next && cur->next->key < key) cur = cur->next;
-        if (cur->next && cur->next->key == key) return true;
-        cur = cur->down;
+/* pulls the --options out of argv; depot ids stay in argv[1..n] */
+int parseArgs(int argc, char **argv, RunOptions &so) {
+    int n = 0;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "--stream") == 0 && a + 1 < argc) so.path = argv[++a];
+        else if (strcmp(argv[a], "--every") == 0 && a + 1 < argc) so.every = atol(argv[++a]);
+        else if (strcmp(argv[a], "--seconds") == 0 && a + 1 < argc) so.seconds = atof(argv[++a]);
+        else if (strcmp(argv[a], "--follow") == 0) so.follow = true;
+        else if (strcmp(argv[a], "--cvrp") == 0 && a + 1 < argc) so.truckKg = atoi(argv[++a]);
+        else argv[++n] = argv[a];
     }
-    return false;
+    return n;
 }
 
 /* ============================================================
    MAIN PROGRAM
    ============================================================ */
 
-int main() {
+int main(int argc, char **argv) {
+    RunOptions so;
+    int nd = parseArgs(argc, argv, so);
 
     cout << "=============================================\n";
     cout << " SAMARTHAKA — Integrated Waste Management\n";
@@ -448,7 +2166,7 @@ int main() {
 
     /* SAMPLE ROWS */
     cout << "Sample rows (first 5):\n";
-    for (int i = 0; i < 5; i++) {
+    for (int i = 0; i < 5 && i < BIN_COUNT; i++) {
         cout << " ID:" << BinID[i]
              << " Zone:" << Zone[i]
              << " Lat:" << fixed << setprecision(4) << Lat[i]
@@ -464,12 +2182,12 @@ int main() {
     /* ----------------------------------------------------------
        1) ROUTE OPTIMIZATION (Bellman–Ford)
        ---------------------------------------------------------- */
-    buildRouteGraph(10);
+    if (!buildRouteGraph(10)) return 0;
 
     cout << "=== ROUTE OPTIMIZATION (Bellman-Ford) ===\n";
     cout << "Route nodes: " << Nnodes << "   Edges: " << edgeCount << "\n";
 
-    bellmanFord(0);
+    shortestPaths(0);
 
     cout << "Nearest reachable routes from depot (0):\n";
     int shown = 0;
@@ -483,37 +2201,56 @@ int main() {
 
     cout << "\n";
 
+    /* depot route ids on the command line: depot x route distance table */
+    if (nd > 0) {
+        int *depots, *table;
+        store.reserve(depots, nd);
+        store.reserve(table, (size_t) nd * Nnodes);
+        bool ok = store.commit();
+        if (ok) {
+            for (int d = 0; d < nd; d++) depots[d] = atoi(argv[d + 1]);
+            ok = depotDistances(depots, nd, table);
+        }
+        if (!ok) {
+            cout << "ERROR: out of memory for " << nd << " depot rows\n";
+            return 0;
+        }
+
+        cout << "=== DEPOT DISTANCE TABLE (" << nd << " depots x " << Nnodes << " routes) ===\n";
+        for (int d = 0; d < nd; d++) {
+            const int *row = table + (size_t) d * Nnodes;
+            int reach = 0, far = 0;
+            for (int r = 0; r < Nnodes; r++)
+                if (row[r] < INF) {
+                    reach++;
+                    if (row[r] > far) far = row[r];
+                }
+            cout << "  Depot " << depots[d] << ": reachable routes=" << reach
+                 << "  farthest=" << far << " m\n";
+        }
+        cout << "\n";
+    }
+
+    // capacitated truck tours from the first depot (route 0 by default)
+    if (so.truckKg > 0) truckTours(nd > 0 ? atoi(argv[1]) : 0, so.truckKg);
+
     /* ----------------------------------------------------------
        2) WASTE SEGREGATION (Normalized)
        ---------------------------------------------------------- */
-    int organic = 0, recyclable = 0, ewaste = 0, hazardous = 0, other = 0;
-
-    for (int i = 0; i < BIN_COUNT; i++) {
-        const char* cat = normalizeWaste(Waste[i]);
-
-        if (strcmp(cat, "organic") == 0) organic++;
-        else if (strcmp(cat, "recyclable") == 0) recyclable++;
-        else if (strcmp(cat, "ewaste") == 0) ewaste++;
-        else if (strcmp(cat, "hazardous") == 0) hazardous++;
-        else other++;
-    }
+    wasteSegregation();
 
     cout << "=== WASTE SEGREGATION (normalized) ===\n";
-    cout << "Organic:     " << organic << "\n";
-    cout << "Recyclable:  " << recyclable << "\n";
-    cout << "E-waste:     " << ewaste << "\n";
-    cout << "Hazardous:   " << hazardous << "\n";
-    cout << "Other:       " << other << "\n\n";
+    cout << "Organic:     " << wasteCats[W_ORGANIC] << "\n";
+    cout << "Recyclable:  " << wasteCats[W_RECYCLABLE] << "\n";
+    cout << "E-waste:     " << wasteCats[W_EWASTE] << "\n";
+    cout << "Hazardous:   " << wasteCats[W_HAZARDOUS] << "\n";
+    cout << "Other:       " << wasteCats[W_OTHER] << "\n\n";
 
     /* ----------------------------------------------------------
-       3) LOAD BALANCING — Red–Black Tree (Top 10)
+       3) LOAD BALANCING — bounded top-K (Top 10)
        ---------------------------------------------------------- */
-    for (int i = 0; i < BIN_COUNT; i++) {
-        RBinsert(NearbyPop[i], BinID[i]);
-    }
-
-    topCnt = 0;
-    collectTopRB(RBroot);
+    buildTopLoads();
+    collectTopLoads();
 
     cout << "Top 10 High-Load Bins (Nearby Population)\n";
     cout << "Rank | BinID | NearbyPop\n";
@@ -527,21 +2264,40 @@ int main() {
     cout << "\n";
 
     /* ----------------------------------------------------------
-       4) SKIP LIST — Fault Detection
+       4) FAULT INDEX — Fault Detection
        ---------------------------------------------------------- */
+    buildFaultIndex();
     for (int i = 0; i < BIN_COUNT; i++) {
-        if (strcmp(Sensor[i], "FAIL") == 0 || strcmp(Sensor[i], "FAULT") == 0)
-            SLinsert(BinID[i]);
+        if (sensorFaulty(i))
+            faultInsert(BinID[i]);
     }
 
+    // heading kept from the skip-list version so reports still diff cleanly
     cout << "=== FAULT DETECTION (Skip List) ===\n";
     cout << "Checking first 20 bins:\n";
 
     for (int i = 0; i < 20; i++) {
-        cout << "Bin " << i << ": " << (SLsearch(i) ? "FAULTY" : "OK") << "\n";
+        cout << "Bin " << i << ": " << (faultSearch(i) ? "FAULTY" : "OK") << "\n";
+    }
+
+    cout << "Faulty bins by zone:\n";
+    for (int z = 0; z < zoneDict.size(); z++) {
+        int first[5];
+        int n = faultyInZone(zoneDict.name(z), first, 5);
+        cout << "  " << zoneDict.name(z) << ": " << n;
+        if (n) {
+            cout << "  (BinIDs";
+            for (int k = 0; k < min(n, 5); k++) cout << " " << first[k];
+            cout << (n > 5 ? " ...)" : ")");
+        }
+        cout << "\n";
     }
 
     cout << "\n=== END OF REPORT ===\n";
 
+    if (so.path) {
+        cout << "\n";
+        return runStream(so);
+    }
     return 0;
 }
@@ -1,6 +1,16 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+#include <chrono>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "../../common/csv_mmap.h"
+#include "../../common/csr_graph.h"
+
 using namespace std;
 
 // =======================================================
@@ -14,9 +24,14 @@ const int INF = 1000000000;
 // GLOBALS
 // =======================================================
 int N = 0;
-int graphMat[MAX_NODES][MAX_NODES];
-int distFW[MAX_NODES][MAX_NODES];
-int nextFW[MAX_NODES][MAX_NODES];
+
+// one link per CSV row; the tower graph is built from these after loading
+int LinkFrom[MAX_NODES], LinkTo[MAX_NODES], LinkDist[MAX_NODES];
+double TowerLat[MAX_NODES], TowerLon[MAX_NODES];   // by tower id
+bool hasGeo[MAX_NODES];
+
+samarthaka::ColumnArena store;
+samarthaka::CsrGraph net;     // both directions of every link, towers 0..N-1
 
 // =======================================================
 // HASH TABLE FOR FAILURE HANDLING
@@ -124,83 +139,155 @@ void findMaxUser(SessionNode* r, int &maxBw, int &userID) {
 // CSV LOADING (STRICT FORMAT)
 // =======================================================
 void loadCSV(const char* file) {
-    ifstream fin(file);
-    if (!fin.is_open()) {
+    samarthaka::CsvReader csv(file);
+    if (!csv.ok()) {
         cout << "ERROR: Cannot open CSV\n";
         exit(0);
     }
 
-    string line;
-    getline(fin, line); // skip header
-
-    int count = 0;
+    // columns: 0 node, 1 zone, 2 lat, 3 lon, 4 to, 5 dist,
+    //          6 backup count, 7..11 backups, 12 user, 13 bandwidth
+    int rows = 0;
+    N = csv.forEachRow([&rows](const samarthaka::CsvRow &row) {
+        int node = row.num<int>(0);
+        int to = row.num<int>(4);
+        int dist = row.num<int>(5);
+
+        LinkFrom[rows] = node;
+        LinkTo[rows] = to;
+        LinkDist[rows] = dist;
+        rows++;
+
+        if (node >= 0 && node < MAX_NODES) {
+            TowerLat[node] = row.num<double>(2);
+            TowerLon[node] = row.num<double>(3);
+            hasGeo[node] = true;
+        }
 
-    while (getline(fin, line) && count < MAX_NODES) {
-        stringstream ss(line);
+        int bcount = row.num<int>(6);
+        int arr[5] = {0};
 
-        string cell;
-        getline(ss, cell, ','); int node = stoi(cell);
-        getline(ss, cell, ','); // zone
-        getline(ss, cell, ','); // lat
-        getline(ss, cell, ','); // lon
+        for (int j=0;j<5;j++)
+            arr[j] = row.num<int>(7 + j);
 
-        getline(ss, cell, ','); int to = stoi(cell);
-        getline(ss, cell, ','); int dist = stoi(cell);
+        insertBackup(node, bcount, arr);
 
-        graphMat[node][to] = dist;
-        graphMat[to][node] = dist;
+        int user = row.num<int>(12);
+        int bw = row.num<int>(13);
 
-        getline(ss, cell, ','); int bcount = stoi(cell);
-        int arr[5] = {0};
+        Root = insertSession(Root, user, bw);
+    }, MAX_NODES);
+}
 
-        for (int j=0;j<5;j++) {
-            getline(ss, cell, ',');
-            arr[j] = stoi(cell);
+// Adjacency of the tower network: O(N + links) memory.  Links to towers
+// outside 0..N-1 are dropped (the searches never reached them before).
+void buildNetwork() {
+    bool ok = net.build(store, N, [](samarthaka::CsrGraph::Sink &arc) {
+        for (int i = 0; i < N; i++) {
+            arc(LinkFrom[i], LinkTo[i], LinkDist[i]);
+            arc(LinkTo[i], LinkFrom[i], LinkDist[i]);
         }
+    });
+    if (!ok) {
+        cout << "ERROR: out of memory for the tower network\n";
+        exit(0);
+    }
+}
 
-        insertBackup(node, bcount, arr);
+// =======================================================
+// INDEXED MIN-HEAP (Prim and routing)
+// =======================================================
+// Ordered by key, ties to the lower tower id: the same tower the old full
+// scan picked.
+int heapNode[MAX_NODES], heapPos[MAX_NODES], heapSize = 0;
+int key[MAX_NODES];
 
-        getline(ss, cell, ','); int user = stoi(cell);
-        getline(ss, cell, ','); int bw = stoi(cell);
+bool heapLess(int a, int b) {
+    return key[a] != key[b] ? key[a] < key[b] : a < b;
+}
 
-        Root = insertSession(Root, user, bw);
+void heapPlace(int i, int v) {
+    heapNode[i] = v;
+    heapPos[v] = i;
+}
+
+void heapUp(int i) {
+    int v = heapNode[i];
+    while (i > 0 && heapLess(v, heapNode[(i-1)/2])) {
+        heapPlace(i, heapNode[(i-1)/2]);
+        i = (i-1)/2;
+    }
+    heapPlace(i, v);
+}
 
-        count++;
+void heapDown(int i) {
+    int v = heapNode[i];
+    while (true) {
+        int c = 2*i + 1;
+        if (c >= heapSize) break;
+        if (c+1 < heapSize && heapLess(heapNode[c+1], heapNode[c])) c++;
+        if (!heapLess(heapNode[c], v)) break;
+        heapPlace(i, heapNode[c]);
+        i = c;
     }
+    heapPlace(i, v);
+}
 
-    N = count;
+void heapReset() {
+    heapSize = 0;
+    for (int i=0;i<N;i++) heapPos[i] = -1;
+}
+
+// key[v] has just gone down
+void heapDecrease(int v) {
+    if (heapPos[v] < 0) {
+        heapPos[v] = heapSize++;
+        heapNode[heapPos[v]] = v;
+    }
+    heapUp(heapPos[v]);
+}
+
+int heapPop() {
+    int v = heapNode[0];
+    heapPos[v] = -1;
+    if (--heapSize > 0) {
+        heapNode[0] = heapNode[heapSize];
+        heapDown(0);
+    }
+    return v;
 }
 
 // =======================================================
 // PRIM’S MST
 // =======================================================
 void runPrim() {
-    bool used[MAX_NODES];
-    int key[MAX_NODES];
-    int parent[MAX_NODES];
+    static bool used[MAX_NODES];
+    static int parent[MAX_NODES];
 
     for (int i=0;i<N;i++) {
         used[i] = false;
         key[i] = INF;
         parent[i] = -1;
     }
+    heapReset();
 
-    key[0] = 0;
-
-    for (int k=0;k<N;k++) {
-        int u = -1, best = INF;
-        for (int i=0;i<N;i++)
-            if (!used[i] && key[i] < best)
-                best = key[i], u = i;
+    if (N > 0) {
+        key[0] = 0;
+        heapDecrease(0);
+    }
 
-        if (u == -1) break;
+    while (heapSize > 0) {
+        int u = heapPop();
         used[u] = true;
 
-        for (int v=0;v<N;v++)
-            if (!used[v] && graphMat[u][v] < key[v]) {
-                key[v] = graphMat[u][v];
+        for (int a=net.begin(u);a<net.end(u);a++) {
+            int v = net.target(a);
+            if (!used[v] && net.weight(a) < key[v]) {
+                key[v] = net.weight(a);
                 parent[v] = u;
+                heapDecrease(v);
             }
+        }
     }
 
     cout << "\n--- COMMUNICATION BACKBONE (PRIM MST) ---\n";
@@ -210,10 +297,10 @@ void runPrim() {
 
     for (int i=1;i<N;i++) {
         if (parent[i] != -1) {
-            total += graphMat[parent[i]][i];
+            total += key[i];
             if (printed < 5) {
                 cout << " " << parent[i] << " → " << i
-                     << " (cost " << graphMat[parent[i]][i] << ")\n";
+                     << " (cost " << key[i] << ")\n";
                 printed++;
             }
         }
@@ -223,34 +310,420 @@ void runPrim() {
 }
 
 // =======================================================
-// FLOYD WARSHALL
+// ROUTING ENGINE
 // =======================================================
-void runFW() {
+// Routes are found on demand.  A first route from a tower runs A* guided by
+// straight-line distance.  A tower asked about again, or the source of a
+// one-to-many query, gets its whole shortest-path tree built once and kept
+// in a small LRU cache; links are two-way, so a cached tree of either end
+// answers a route.  With --matrix (at most FW_MAX_NODES towers) every route
+// is read from an all-pairs matrix instead.
+const int ROUTE_CACHE = 8;
+const double EARTH_KM = 6371.0;
+
+struct RouteTree {
+    int source;         // -1 while the slot is empty
+    long long used;     // LRU stamp
+    int *dist;
+    int *prev;          // next tower on the way back to source
+};
+RouteTree trees[ROUTE_CACHE];
+long long routeClock = 0;
+bool askedBefore[MAX_NODES];
+
+double costPerKm = 0;   // cost >= costPerKm * km on every link: A*'s lower bound
+int gDist[MAX_NODES];   // A* cost so far; key[] holds cost + estimate
+int prevHop[MAX_NODES];
+
+int routePath[MAX_NODES], routeLen = 0;   // last route found, source first
+long long treeHits = 0, treesBuilt = 0, aStarRuns = 0, matrixReads = 0;
+
+int *fwDist = nullptr, *fwNext = nullptr;    // set by buildMatrix()
+size_t fwStride = 0;
+
+double geoKm(int a, int b) {
+    const double r = M_PI / 180;
+    double dLat = (TowerLat[b] - TowerLat[a]) * r, dLon = (TowerLon[b] - TowerLon[a]) * r;
+    double h = sin(dLat/2) * sin(dLat/2) +
+               cos(TowerLat[a] * r) * cos(TowerLat[b] * r) * sin(dLon/2) * sin(dLon/2);
+    return 2 * EARTH_KM * asin(min(1.0, sqrt(h)));
+}
+
+// lower bound on the cost x -> t
+int estimate(int x, int t) {
+    if (costPerKm <= 0) return 0;
+    return (int) min((double) INF, costPerKm * geoKm(x, t));
+}
+
+void initRouting() {
+    for (int c=0;c<ROUTE_CACHE;c++) {
+        trees[c].source = -1;
+        store.reserve(trees[c].dist, N);
+        store.reserve(trees[c].prev, N);
+    }
+    if (!store.commit()) {
+        cout << "ERROR: out of memory for the route cache\n";
+        exit(0);
+    }
+
+    // The cheapest link per km bounds every route (slightly shrunk for
+    // rounding), but only if every tower has coordinates: a route through
+    // towers without any could be cheaper than the bound.  Else plain Dijkstra.
+    costPerKm = 0;
     for (int i=0;i<N;i++)
-        for (int j=0;j<N;j++) {
-            distFW[i][j] = graphMat[i][j];
-            nextFW[i][j] = (graphMat[i][j] < INF && i != j ? j : -1);
+        if (!hasGeo[i]) return;
+    costPerKm = -1;
+    for (int i=0;i<N;i++) {
+        int u = LinkFrom[i], v = LinkTo[i];
+        if (u < 0 || u >= N || v < 0 || v >= N || !hasGeo[u] || !hasGeo[v]) continue;
+        double km = geoKm(u, v);
+        if (km <= 0) continue;
+        double c = LinkDist[i] / km;
+        if (costPerKm < 0 || c < costPerKm) costPerKm = c;
+    }
+    costPerKm = costPerKm > 0 ? costPerKm * (1 - 1e-9) : 0;
+}
+
+RouteTree *findTree(int s) {
+    for (int c=0;c<ROUTE_CACHE;c++)
+        if (trees[c].source == s) {
+            trees[c].used = ++routeClock;
+            return &trees[c];
+        }
+    return nullptr;
+}
+
+// builds s's tree over the least recently used slot
+RouteTree *growTree(int s) {
+    RouteTree *t = &trees[0];
+    for (int c=1;c<ROUTE_CACHE;c++)
+        if (trees[c].used < t->used) t = &trees[c];
+
+    for (int i=0;i<N;i++) {
+        key[i] = INF;
+        t->prev[i] = -1;
+    }
+    heapReset();
+    key[s] = 0;
+    heapDecrease(s);
+    while (heapSize > 0) {
+        int x = heapPop();
+        for (int a=net.begin(x);a<net.end(x);a++) {
+            int y = net.target(a), nd = key[x] + net.weight(a);
+            if (nd < key[y]) {
+                key[y] = nd;
+                t->prev[y] = x;
+                heapDecrease(y);
+            }
+        }
+    }
+    memcpy(t->dist, key, sizeof(int) * N);
+    t->source = s;
+    t->used = ++routeClock;
+    treesBuilt++;
+    return t;
+}
+
+// A* from u, stopping at v; the path is left in prevHop
+int aStar(int u, int v) {
+    for (int i=0;i<N;i++) {
+        gDist[i] = INF;
+        key[i] = INF;
+        prevHop[i] = -1;
+    }
+    heapReset();
+    gDist[u] = 0;
+    key[u] = estimate(u, v);
+    heapDecrease(u);
+
+    while (heapSize > 0) {
+        int x = heapPop();
+        if (x == v) break;
+        for (int a=net.begin(x);a<net.end(x);a++) {
+            int y = net.target(a), nd = gDist[x] + net.weight(a);
+            if (nd < gDist[y]) {
+                gDist[y] = nd;
+                prevHop[y] = x;
+                key[y] = nd + estimate(y, v);
+                heapDecrease(y);
+            }
         }
+    }
+    aStarRuns++;
+    return gDist[v];
+}
+
+// path v .. u along back[] (back[x] = previous hop), stored source first
+void pathBack(const int *back, int u, int v) {
+    routeLen = 0;
+    for (int x=v; x!=-1 && routeLen<N; x=back[x]) {
+        routePath[routeLen++] = x;
+        if (x == u) break;
+    }
+    for (int i=0, j=routeLen-1; i<j; i++, j--) swap(routePath[i], routePath[j]);
+}
+
+// path u .. v along ahead[] (ahead[x] = next hop toward v)
+void pathAhead(const int *ahead, int u, int v) {
+    routeLen = 0;
+    for (int x=u; x!=-1 && routeLen<N; x=ahead[x]) {
+        routePath[routeLen++] = x;
+        if (x == v) break;
+    }
+}
+
+// path u .. v along the matrix's first hops
+void pathMatrix(int u, int v) {
+    routeLen = 0;
+    for (int x=u; x!=-1 && routeLen<N; x=fwNext[x * fwStride + v]) {
+        routePath[routeLen++] = x;
+        if (x == v) break;
+    }
+}
+
+// shortest cost u -> v (INF if unreachable); the route is left in routePath
+int routeTo(int u, int v) {
+    routeLen = 0;
+    if (u < 0 || u >= N || v < 0 || v >= N) return INF;
+
+    RouteTree *t = nullptr;
+    bool fromV = false;
+    if (!fwDist) {
+        if ((t = findTree(u))) treeHits++;
+        else if ((t = findTree(v))) {
+            treeHits++;
+            fromV = true;
+        }
+        else if (askedBefore[u]) t = growTree(u);
+    }
+
+    int d;
+    if (fwDist) {
+        matrixReads++;
+        d = fwDist[u * fwStride + v];
+        if (d < INF) pathMatrix(u, v);
+    } else if (t && !fromV) {
+        d = t->dist[v];
+        if (d < INF) pathBack(t->prev, u, v);
+    } else if (t) {
+        d = t->dist[u];
+        if (d < INF) pathAhead(t->prev, u, v);
+    } else {
+        d = aStar(u, v);
+        if (d < INF) pathBack(prevHop, u, v);
+    }
+    askedBefore[u] = true;
+    return d;
+}
+
+// costs from u to each of to[0..k) into out[]
+void routeMany(int u, const int *to, int k, int *out) {
+    for (int j=0;j<k;j++) out[j] = INF;
+    if (u < 0 || u >= N) return;
+    const int *dist;
+    if (fwDist) {
+        matrixReads++;
+        dist = fwDist + u * fwStride;
+    } else {
+        RouteTree *t = findTree(u);
+        if (t) treeHits++;
+        else t = growTree(u);
+        dist = t->dist;
+    }
+    for (int j=0;j<k;j++)
+        if (to[j] >= 0 && to[j] < N) out[j] = dist[to[j]];
+    askedBefore[u] = true;
+}
+
+void printPath() {
+    for (int i=0;i<routeLen;i++) {
+        if (i) cout << " → ";
+        cout << routePath[i];
+    }
+}
+
+// =======================================================
+// ALL-PAIRS MATRIX (BLOCKED FLOYD WARSHALL)
+// =======================================================
+// Only for networks small enough to want every route: towers are padded to
+// FW_BLOCK-sized tiles and each round (one diagonal tile, then its row and
+// column, then the rest) runs the min-plus row update on all cores, 8 lanes
+// at a time where AVX2 is available.  fwNext keeps the first hop of every
+// route.
+const int FW_MAX_NODES = 4096;
+const int FW_BLOCK = 64;
+
+typedef void (*MinPlusFn)(int *dist, int *next, const int *krow, int a, int hop, int len);
+
+// dist[j] = min(dist[j], a + krow[j]); improved entries take first hop `hop`
+void minPlusScalar(int *dist, int *next, const int *krow, int a, int hop, int len) {
+    for (int j=0;j<len;j++) {
+        int s = a + krow[j];
+        if (s < dist[j]) {
+            dist[j] = s;
+            next[j] = hop;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+__attribute__((target("avx2")))
+void minPlusAvx2(int *dist, int *next, const int *krow, int a, int hop, int len) {
+    const __m256i va = _mm256_set1_epi32(a), vh = _mm256_set1_epi32(hop);
+    for (int j=0;j<len;j+=8) {
+        __m256i s = _mm256_add_epi32(va, _mm256_loadu_si256((const __m256i *) (krow + j)));
+        __m256i d = _mm256_loadu_si256((const __m256i *) (dist + j));
+        __m256i better = _mm256_cmpgt_epi32(d, s);
+        __m256i n = _mm256_loadu_si256((const __m256i *) (next + j));
+        _mm256_storeu_si256((__m256i *) (dist + j), _mm256_min_epi32(d, s));
+        _mm256_storeu_si256((__m256i *) (next + j), _mm256_blendv_epi8(n, vh, better));
+    }
+}
+#endif
+
+MinPlusFn pickMinPlus() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return minPlusAvx2;
+#endif
+    return minPlusScalar;
+}
+MinPlusFn minPlus = pickMinPlus();
+
+// tile (ib, jb) relaxed through the towers of tile column kb
+void fwTile(int ib, int jb, int kb) {
+    int i0 = ib * FW_BLOCK, j0 = jb * FW_BLOCK, k0 = kb * FW_BLOCK;
+    for (int k=k0;k<k0+FW_BLOCK;k++) {
+        const int *krow = fwDist + k * fwStride + j0;
+        for (int i=i0;i<i0+FW_BLOCK;i++) {
+            size_t ik = i * fwStride + k;
+            if (fwDist[ik] >= INF) continue;
+            minPlus(fwDist + i * fwStride + j0, fwNext + i * fwStride + j0, krow,
+                    fwDist[ik], fwNext[ik], FW_BLOCK);
+        }
+    }
+}
 
-    for (int k=0;k<N;k++)
-        for (int i=0;i<N;i++)
-            if (distFW[i][k] < INF)
-                for (int j=0;j<N;j++)
-                    if (distFW[k][j] < INF) {
-                        int nd = distFW[i][k] + distFW[k][j];
-                        if (nd < distFW[i][j]) {
-                            distFW[i][j] = nd;
-                            nextFW[i][j] = nextFW[i][k];
-                        }
-                    }
+// runs work(t) for t in [0, threads), t = 0 on the calling thread
+template <class F>
+void parallelFor(int threads, F work) {
+    thread *pool = new thread[threads - 1];
+    for (int t=1;t<threads;t++) pool[t - 1] = thread(work, t);
+    work(0);
+    for (int t=1;t<threads;t++) pool[t - 1].join();
+    delete[] pool;
 }
 
-void printPath(int u, int v) {
-    while (u != v) {
-        cout << u << " → ";
-        u = nextFW[u][v];
+// false if the network is too big or memory runs out
+bool buildMatrix(int threads) {
+    if (N == 0 || N > FW_MAX_NODES) return false;
+    int tiles = (N + FW_BLOCK - 1) / FW_BLOCK;
+    fwStride = (size_t) tiles * FW_BLOCK;
+    int *d, *nx;
+    store.reserve(d, fwStride * fwStride);
+    store.reserve(nx, fwStride * fwStride);
+    if (!store.commit()) return false;
+
+    for (size_t i=0;i<fwStride;i++)
+        for (size_t j=0;j<fwStride;j++) {
+            d[i * fwStride + j] = i == j ? 0 : INF;
+            nx[i * fwStride + j] = i == j ? (int) i : -1;
+        }
+    for (int u=0;u<N;u++)
+        for (int a=net.begin(u);a<net.end(u);a++) {
+            int v = net.target(a);
+            if (u != v && net.weight(a) < d[u * fwStride + v]) {
+                d[u * fwStride + v] = net.weight(a);
+                nx[u * fwStride + v] = v;
+            }
+        }
+    fwDist = d;
+    fwNext = nx;
+
+    if (threads > tiles) threads = tiles;
+    for (int kb=0;kb<tiles;kb++) {
+        fwTile(kb, kb, kb);
+        // tile row and column of kb: tiles [0, tiles) then [tiles, 2 * tiles)
+        parallelFor(threads, [&](int t) {
+            for (int x=t;x<2*tiles;x+=threads) {
+                int b = x % tiles;
+                if (b == kb) continue;
+                if (x < tiles) fwTile(kb, b, kb);
+                else fwTile(b, kb, kb);
+            }
+        });
+        parallelFor(threads, [&](int t) {
+            for (int ib=t;ib<tiles;ib+=threads) {
+                if (ib == kb) continue;
+                for (int jb=0;jb<tiles;jb++)
+                    if (jb != kb) fwTile(ib, jb, kb);
+            }
+        });
     }
-    cout << v;
+    return true;
+}
+
+// =======================================================
+// ROUTE QUERIES
+// =======================================================
+// One query per line from file or stdin ("-"):
+//   u v            cheapest route u -> v with its towers
+//   u v1 v2 ...    costs from u to each of v1, v2, ...
+int runRoutes(const char *file) {
+    FILE *in = strcmp(file, "-") == 0 ? stdin : fopen(file, "r");
+    if (!in) {
+        cout << "ERROR: Cannot open " << file << "\n";
+        return 1;
+    }
+    cout << "\n--- ROUTE QUERIES ---\n";
+    static char line[1 << 16];
+    static int ids[MAX_NODES + 1], out[MAX_NODES];
+    long long queries = 0;
+    double ms = 0;
+    while (fgets(line, sizeof(line), in)) {
+        char *p = line, *end;
+        int k = 0;
+        bool bad = false;
+        while (true) {
+            while (*p == ' ' || *p == '\t' || *p == ',') p++;
+            if (*p == '\n' || *p == '\r' || *p == 0 || *p == '#') break;
+            long x = strtol(p, &end, 10);
+            if (end == p || k == MAX_NODES + 1) { bad = true; break; }
+            ids[k++] = (int) x;
+            p = end;
+        }
+        if (k == 0 && !bad) continue;
+        if (bad || k < 2) {
+            cout << " bad query: " << line;
+            continue;
+        }
+
+        auto t0 = chrono::steady_clock::now();
+        int d = INF;
+        if (k == 2) d = routeTo(ids[0], ids[1]);
+        else routeMany(ids[0], ids + 1, k - 1, out);
+        ms += chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+        queries++;
+
+        if (k > 2) {
+            for (int j=1;j<k;j++) {
+                cout << " " << ids[0] << " → " << ids[j];
+                if (out[j - 1] >= INF) cout << ": unreachable\n";
+                else cout << " (cost " << out[j - 1] << ")\n";
+            }
+        } else if (d >= INF) {
+            cout << " " << ids[0] << " → " << ids[1] << ": unreachable\n";
+        } else {
+            cout << " " << ids[0] << " → " << ids[1] << " (cost " << d << ")\n   ";
+            printPath();
+            cout << "\n";
+        }
+    }
+    if (in != stdin) fclose(in);
+    cout << " Queries: " << queries << "   tree hits: " << treeHits << "   trees built: " << treesBuilt
+         << "   A* searches: " << aStarRuns << "   matrix reads: " << matrixReads
+         << "   avg " << (queries ? ms * 1000 / queries : 0.0) << " us/query\n";
+    return 0;
 }
 
 // =======================================================
@@ -282,11 +755,18 @@ void failureDemo() {
 // =======================================================
 // MAIN
 // =======================================================
-int main() {
-
-    for (int i=0;i<MAX_NODES;i++)
-        for (int j=0;j<MAX_NODES;j++)
-            graphMat[i][j] = (i==j ? 0 : INF);
+int main(int argc, char **argv) {
+
+    const char *routeFile = nullptr;
+    bool matrix = false;
+    for (int a=1;a<argc;a++) {
+        if (strcmp(argv[a], "--routes") == 0 && a + 1 < argc) routeFile = argv[++a];
+        else if (strcmp(argv[a], "--matrix") == 0) matrix = true;
+        else {
+            cerr << "Usage: " << argv[0] << " [--routes file|-] [--matrix]\n";
+            return 1;
+        }
+    }
 
     initHash();
 
@@ -297,17 +777,34 @@ int main() {
 
     cout << "Loaded Nodes: " << N << "\n";
 
+    buildNetwork();
+    initRouting();
     runPrim();
 
-    runFW();
-    cout << "\n--- ROUTING ENGINE (FLOYD WARSHALL) ---\n";
+    cout << "\n--- ROUTING ENGINE ---\n";
+    if (matrix) {
+        int threads = max(1u, thread::hardware_concurrency());
+        auto t0 = chrono::steady_clock::now();
+        if (buildMatrix(threads)) {
+            double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+            cout << " All-pairs matrix: " << N << " towers in " << (long long) ms << " ms\n";
+        } else {
+            cout << " All-pairs matrix skipped (over " << FW_MAX_NODES
+                 << " towers or out of memory); routing on demand\n";
+        }
+    }
     int tests[2][2] = {{0,50},{20,999}};
 
     for (int i=0;i<2;i++) {
         int u = tests[i][0], v = tests[i][1];
+        int d = routeTo(u, v);
+        if (d >= INF) {
+            cout << " Fastest path " << u << " → " << v << ": unreachable\n";
+            continue;
+        }
         cout << " Fastest path " << u << " → " << v
-             << " (cost " << distFW[u][v] << ")\n   ";
-        printPath(u,v);
+             << " (cost " << d << ")\n   ";
+        printPath();
         cout << "\n";
     }
 
@@ -329,5 +826,6 @@ int main() {
          << " (" << maxBW << " Mbps)\n";
 
     cout << "\nDONE.\n";
+    if (routeFile) return runRoutes(routeFile);
     return 0;
 }
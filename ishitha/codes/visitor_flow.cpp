@@ -1,9 +1,9 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cstdlib>
 
+#include "../../common/csv_mmap.h"
+
 using namespace std;
 
 const int MAXR = 10050;
@@ -23,28 +23,17 @@ int ROWS = 0;
 
 /* ==== Load CSV ==== */
 void loadCSV(const char *file) {
-    ifstream fin(file);
-    if(!fin){ cout<<"CSV file missing.\n"; exit(1); }
-
-    string line;
-    getline(fin, line); // header
-
-    while(getline(fin, line) && ROWS < MAXR-1) {
-        stringstream ss(line);
-        string t;
-
-        getline(ss,t,','); VisitorID[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); Zone[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); TimeAt[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); Density[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); U[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); V[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); W[ROWS] = atoi(t.c_str());
-        getline(ss,t,','); TaskPriority[ROWS] = atoi(t.c_str());
-
-        ROWS++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, VisitorID);
+    csv.bind(1, Zone);
+    csv.bind(2, TimeAt);
+    csv.bind(3, Density);
+    csv.bind(4, U);
+    csv.bind(5, V);
+    csv.bind(6, W);
+    csv.bind(7, TaskPriority);
+    ROWS = csv.load(file, MAXR-1, samarthaka::CSV_SNAPSHOT);
+    if(ROWS < 0){ cout<<csv.error()<<"\n"; exit(1); }
 }
 
 /* ======================================================
@@ -1,15 +1,15 @@
 #include <iostream>
-#include <fstream>
-#include <sstream>
 #include <cstring>
 #include <cmath>
 #include <cstdlib>
 
+#include "../../common/csv_mmap.h"
+#include "../../common/csr_graph.h"
+
 using namespace std;
 
 const int MAXR = 10050;
 const int MAXN = 10050;
-const int MAXE = 40050;
 const int INF = 1000000000;
 
 /* ========= CSV DATA ARRAYS ========= */
@@ -24,26 +24,17 @@ int ROWS = 0;
 
 /* ========= CSV LOADER ========= */
 void loadCSV(const char *fn){
-    ifstream fin(fn);
-    if(!fin){ cout<<"File not found!\n"; exit(1); }
-
-    string line;
-    getline(fin,line);
-
-    while(getline(fin,line) && ROWS < MAXR-2){
-        stringstream ss(line);
-        string t;
-        getline(ss,t,','); WaferID[ROWS]=atoi(t.c_str());
-        getline(ss,t,','); LayerCount[ROWS]=atoi(t.c_str());
-        getline(ss,t,','); strncpy(Pattern[ROWS],t.c_str(),79);
-        getline(ss,t,','); strncpy(ReferencePat[ROWS],t.c_str(),79);
-        getline(ss,t,','); ConnA[ROWS]=atoi(t.c_str());
-        getline(ss,t,','); ConnB[ROWS]=atoi(t.c_str());
-        getline(ss,t,','); DefectScore[ROWS]=atof(t.c_str());
-        getline(ss,t,','); Yield[ROWS]=atof(t.c_str());
-        ROWS++;
-    }
-    fin.close();
+    samarthaka::CsvBinding csv;
+    csv.bind(0, WaferID);
+    csv.bind(1, LayerCount);
+    csv.bind(2, Pattern);
+    csv.bind(3, ReferencePat);
+    csv.bind(4, ConnA);
+    csv.bind(5, ConnB);
+    csv.bind(6, DefectScore);
+    csv.bind(7, Yield);
+    ROWS = csv.load(fn, MAXR-2, samarthaka::CSV_SNAPSHOT);
+    if(ROWS < 0){ cout<<csv.error()<<"\n"; exit(1); }
 }
 
 /* ========= 1) BACKTRACKING: LITHOGRAPHY LAYER ORDERING ========= */
@@ -102,11 +93,19 @@ bool kmpSearch(const char *text, const char *pat){
 }
 
 /* ========= 3) DIJKSTRA FOR ELECTRICAL PATH VALIDATION ========= */
-int head[MAXN], toE[MAXE], costE[MAXE], nxt[MAXE], ec = 0;
+samarthaka::ColumnArena store;
+samarthaka::CsrGraph net;     /* nodes 0..ROWS, wafer ids from 1 */
 int distA[MAXN], usedA[MAXN], par[MAXN];
 
-void addEdge(int u,int v,int w){
-    toE[ec]=v; costE[ec]=w; nxt[ec]=head[u]; head[u]=ec++; 
+/* wafer -> ConnA and wafer -> ConnB, unit cost */
+void buildGraph(int maxNode){
+    bool ok = net.build(store, maxNode+1, [](samarthaka::CsrGraph::Sink &arc){
+        for(int i=0;i<ROWS;i++){
+            arc(WaferID[i], ConnA[i], 1);
+            arc(WaferID[i], ConnB[i], 1);
+        }
+    });
+    if(!ok){ cout<<"Out of memory for the wafer graph\n"; exit(1); }
 }
 
 void dijkstra(int src, int N){
@@ -121,10 +120,10 @@ void dijkstra(int src, int N){
             if(!usedA[i] && distA[i]<best){ best=distA[i]; v=i; }
         if(v==-1) break;
         usedA[v]=1;
-        for(int e=head[v];e!=-1;e=nxt[e]){
-            int u=toE[e];
-            if(distA[v]+costE[e] < distA[u]){
-                distA[u]=distA[v]+costE[e];
+        for(int e=net.begin(v);e<net.end(v);e++){
+            int u=net.target(e);
+            if(distA[v]+net.weight(e) < distA[u]){
+                distA[u]=distA[v]+net.weight(e);
                 par[u]=v;
             }
         }
@@ -186,12 +185,7 @@ int main(){
     /* ---- BUILD GRAPH ---- */
     cout<<"\n=== (3) ELECTRICAL PATH VALIDATION (Dijkstra) ===\n";
     int maxNode = ROWS;
-    for(int i=1;i<=maxNode;i++) head[i]=-1;
-    ec = 0;
-    for(int i=0;i<ROWS;i++){
-        addEdge(WaferID[i], ConnA[i], 1);
-        addEdge(WaferID[i], ConnB[i], 1);
-    }
+    buildGraph(maxNode);
 
     dijkstra(1, maxNode);
     cout<<"Shortest electrical path from wafer 1 to wafer "<<ROWS<<":\n";